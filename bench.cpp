@@ -0,0 +1,1014 @@
+// Mediciones de rendimiento del catálogo. Cada una reproduce con datos
+// sintéticos lo que pidió su cambio y, cuando tiene sentido, lo compara con
+// la forma en que se hacía antes. Se compila junto con main.cpp (sin su
+// main) mediante "make bench".
+//
+// Uso: catalogo_bench [--escala=F] [--portadas=DIR] [medición...]
+// Sin nombres se corren todas; --lista muestra cuáles hay. --escala
+// multiplica los tamaños: con 1 son los de cada pedido (1M de líneas, 5M y
+// 10M de títulos, un archivo de 1 GB), que piden varios GB de memoria.
+#define CATALOGO_SIN_MAIN
+#include "main.cpp"
+
+#include <cstdarg>
+
+namespace {
+
+double escala = 1.0;
+std::string directorioPortadas;
+std::filesystem::path directorioTemporal;
+
+size_t escalar(size_t n) {
+    return std::max<size_t>(1, static_cast<size_t>(static_cast<double>(n) * escala));
+}
+
+class Cronometro {
+private:
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+public:
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    }
+};
+
+// Evita que el compilador descarte resultados que nadie usa
+volatile double sumidero = 0;
+
+void encabezado(const char* pedido, const char* descripcion) {
+    std::printf("\n[%s] %s\n", pedido, descripcion);
+}
+
+void resultado(const char* formato, ...) {
+    std::va_list argumentos;
+    va_start(argumentos, formato);
+    std::printf("  ");
+    std::vprintf(formato, argumentos);
+    std::printf("\n");
+    va_end(argumentos);
+    std::fflush(stdout);
+}
+
+double megabytesPorSegundo(size_t bytes, double ms) {
+    return ms > 0 ? bytes / (1024.0 * 1024.0) / (ms / 1000.0) : 0;
+}
+
+// Memoria residente del proceso en bytes; 0 si el sistema no la informa
+size_t memoriaResidente() {
+#ifdef __linux__
+    FILE* archivo = std::fopen("/proc/self/statm", "r");
+    if (!archivo) return 0;
+    unsigned long total = 0, residente = 0;
+    int leidos = std::fscanf(archivo, "%lu %lu", &total, &residente);
+    std::fclose(archivo);
+    return leidos == 2 ? residente * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Datos sintéticos
+
+uint64_t mezclar(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+const char* const GENEROS[] = {
+    "Accion", "Animacion", "Aventura", "Ciencia ficcion", "Comedia", "Documental",
+    "Drama", "Fantasia", "Romance", "Suspenso", "Terror"
+};
+const size_t NUM_GENEROS = sizeof(GENEROS) / sizeof(GENEROS[0]);
+
+// Uno de cada mil títulos es "Musical", para tener un género raro
+const char* generoSintetico(size_t i) {
+    uint64_t h = mezclar(i * 3 + 1);
+    return h % 1000 == 0 ? "Musical" : GENEROS[h % NUM_GENEROS];
+}
+
+std::string tituloSintetico(size_t i) { return "Titulo sintetico " + std::to_string(i); }
+std::string directorSintetico(size_t i) { return "Director " + std::to_string(mezclar(i * 3 + 2) % 20000); }
+double calificacionSintetica(size_t i) { return static_cast<double>(mezclar(i) % 101) / 10.0; }
+int anioSintetico(size_t i) { return 1950 + static_cast<int>(mezclar(i * 7) % 75); }
+
+// Una de cada cinco filas es serie
+std::vector<std::shared_ptr<Video>> crearCatalogo(size_t n) {
+    std::vector<std::shared_ptr<Video>> catalogo;
+    catalogo.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (i % 5 == 4) {
+            catalogo.push_back(std::make_shared<Serie>(tituloSintetico(i), calificacionSintetica(i), 12,
+                                                       generoSintetico(i), 3, 36, directorSintetico(i)));
+        } else {
+            catalogo.push_back(std::make_shared<Pelicula>(tituloSintetico(i), calificacionSintetica(i), 95,
+                                                          generoSintetico(i), directorSintetico(i),
+                                                          anioSintetico(i)));
+        }
+    }
+    return catalogo;
+}
+
+// Video como era antes del almacén columnar: un objeto en el heap con sus
+// propias cadenas y getters que devuelven copias
+class VideoAntiguo {
+protected:
+    std::string titulo;
+    double calificacion;
+    std::string genero;
+    std::string director;
+    int anio;
+    std::string rutaPortada;
+    std::string basePath;
+
+public:
+    VideoAntiguo(const std::string& t, double cal, const std::string& g, const std::string& dir, int a)
+        : titulo(t), calificacion(cal), genero(g), director(dir), anio(a), basePath(".\\") {
+        rutaPortada = basePath + "portadas\\" + tituloANombreArchivo(titulo) + ".jpg";
+    }
+    virtual ~VideoAntiguo() = default;
+
+    virtual std::string getTipo() const = 0;
+    std::string getTitulo() const { return titulo; }
+    std::string getGenero() const { return genero; }
+    std::string getDirector() const { return director; }
+    double getCalificacion() const { return calificacion; }
+
+    // Bytes que ocupan en el heap las cadenas que no caben en el propio objeto
+    size_t bytesCadenas() const {
+        size_t total = 0;
+        for (const std::string* s : { &titulo, &genero, &director, &rutaPortada, &basePath }) {
+            if (s->capacity() > 15) total += s->capacity() + 1;
+        }
+        return total;
+    }
+};
+
+class PeliculaAntigua : public VideoAntiguo {
+private:
+    int duracion;
+
+public:
+    PeliculaAntigua(const std::string& t, double cal, int d, const std::string& g, const std::string& dir, int a)
+        : VideoAntiguo(t, cal, g, dir, a), duracion(d) {}
+    std::string getTipo() const override { return "Pelicula"; }
+};
+
+class SerieAntigua : public VideoAntiguo {
+private:
+    int episodiosPorTemporada, numTemporadas, totalEpisodios;
+
+public:
+    SerieAntigua(const std::string& t, double cal, int ept, const std::string& g, int nt, int te,
+                 const std::string& dir)
+        : VideoAntiguo(t, cal, g, dir, 0), episodiosPorTemporada(ept), numTemporadas(nt), totalEpisodios(te) {}
+    std::string getTipo() const override { return "Serie"; }
+};
+
+std::vector<std::shared_ptr<VideoAntiguo>> crearCatalogoAntiguo(size_t n) {
+    std::vector<std::shared_ptr<VideoAntiguo>> catalogo;
+    catalogo.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (i % 5 == 4) {
+            catalogo.push_back(std::make_shared<SerieAntigua>(tituloSintetico(i), calificacionSintetica(i), 12,
+                                                              generoSintetico(i), 3, 36, directorSintetico(i)));
+        } else {
+            catalogo.push_back(std::make_shared<PeliculaAntigua>(tituloSintetico(i), calificacionSintetica(i), 95,
+                                                                 generoSintetico(i), directorSintetico(i),
+                                                                 anioSintetico(i)));
+        }
+    }
+    return catalogo;
+}
+
+// División de líneas como la hacía procesarArchivoDatos antes del lector
+std::vector<std::string> dividirCadena(const std::string& cadena, char separador) {
+    std::vector<std::string> resultado;
+    std::stringstream ss(cadena);
+    std::string item;
+    while (std::getline(ss, item, separador)) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        resultado.push_back(item);
+    }
+    return resultado;
+}
+
+// Archivo de datos con todos los tipos de registro, escrito una sola vez
+// por ejecución en el directorio temporal
+const std::string& archivoDatos() {
+    static std::string ruta;
+    if (!ruta.empty()) return ruta;
+    ruta = (directorioTemporal / "datos.txt").string();
+
+    const size_t objetivo = escalar(size_t(1) << 30);
+    const size_t titulos = std::max<size_t>(1000, objetivo / 512);
+    FILE* archivo = std::fopen(ruta.c_str(), "wb");
+    if (!archivo) throw std::runtime_error("no se pudo crear " + ruta);
+    std::string bloque;
+    size_t escritos = 0;
+    for (size_t i = 0; escritos < objetivo; i++) {
+        size_t t = mezclar(i) % titulos;
+        char calificacion[8];
+        std::snprintf(calificacion, sizeof(calificacion), "%.1f", calificacionSintetica(i));
+        switch (i % 20) {
+            case 0: case 1: case 2: case 3: case 4:
+                bloque += "PELICULA|" + tituloSintetico(i) + "|" + calificacion + "|95|" + generoSintetico(i) +
+                          "|" + directorSintetico(i) + "|" + std::to_string(anioSintetico(i)) + "\n";
+                break;
+            case 5: case 6:
+                bloque += "SERIE|" + tituloSintetico(i) + "|" + calificacion + "|12|" + generoSintetico(i) +
+                          "|3|36|" + directorSintetico(i) + "\n";
+                break;
+            case 7: case 8: case 9:
+                bloque += "USUARIO_CALIFICACION|usuario" + std::to_string(i % 977) + "|" + tituloSintetico(t) +
+                          "|" + std::to_string(i % 11) + "\n";
+                break;
+            case 10: case 11:
+                bloque += std::string("GENERO|") + tituloSintetico(t) + "|" + generoSintetico(i) + "\n";
+                break;
+            default:
+                bloque += "CALIFICACION|" + tituloSintetico(t) + "|" + calificacion + "\n";
+                break;
+        }
+        if (bloque.size() >= (4u << 20)) {
+            std::fwrite(bloque.data(), 1, bloque.size(), archivo);
+            escritos += bloque.size();
+            bloque.clear();
+        }
+    }
+    std::fwrite(bloque.data(), 1, bloque.size(), archivo);
+    std::fclose(archivo);
+    return ruta;
+}
+
+// ---------------------------------------------------------------------------
+// Mediciones
+
+// user-001: importar calificaciones contra un catálogo grande
+void medirIndiceTitulos() {
+    encabezado("user-001", "CALIFICACION contra un catálogo: índice por título vs recorrido lineal");
+    size_t n = escalar(500000);
+    size_t m = escalar(1000000);
+    auto catalogo = crearCatalogo(n);
+    IndiceTitulos indice;
+    indice.reserve(n);
+    for (const auto& video : catalogo) indice.emplace(video->getTitulo(), video);
+
+    // Uno de cada once títulos no está en el catálogo
+    std::string datos;
+    for (size_t j = 0; j < m; j++) {
+        datos += "CALIFICACION|" + tituloSintetico(mezclar(j) % (n + n / 10)) + "|7.5\n";
+    }
+
+    Cronometro conIndice;
+    LectorRegistros lector{std::string_view(datos)};
+    RegistroDatos registro;
+    std::string titulo;
+    size_t actualizadas = 0;
+    while (lector.siguiente(registro)) {
+        OperacionDatos op = OperacionDatos::interpretar(registro);
+        titulo.assign(registro.campos[1]);
+        auto it = indice.find(titulo);
+        if (it != indice.end()) {
+            it->second->setCalificacion(op.calificacion);
+            actualizadas++;
+        }
+    }
+    double msIndice = conIndice.ms();
+
+    // El recorrido lineal se mide sobre unas pocas líneas y se extrapola
+    size_t muestra = std::min<size_t>(m, 200);
+    Cronometro lineal;
+    LectorRegistros lectorMuestra{std::string_view(datos)};
+    for (size_t j = 0; j < muestra && lectorMuestra.siguiente(registro); j++) {
+        OperacionDatos op = OperacionDatos::interpretar(registro);
+        titulo.assign(registro.campos[1]);
+        for (const auto& video : catalogo) {
+            if (video->getTitulo() == titulo) {
+                video->setCalificacion(op.calificacion);
+                break;
+            }
+        }
+    }
+    double msPorLineaLineal = lineal.ms() / muestra;
+
+    resultado("%zu títulos, %zu líneas (%zu actualizadas)", n, m, actualizadas);
+    resultado("índice por título:   %10.1f ms  (%.0f ns/línea)", msIndice, msIndice * 1e6 / m);
+    resultado("recorrido lineal:    %10.1f ms estimados  (%.0f ns/línea, medido en %zu líneas)",
+              msPorLineaLineal * m, msPorLineaLineal * 1e6, muestra);
+}
+
+// user-002: lector sin copias vs getline + dividirCadena + stod
+void medirLectorRegistros() {
+    encabezado("user-002", "Interpretar el archivo de datos: getline + dividirCadena vs LectorRegistros");
+    const std::string& ruta = archivoDatos();
+    size_t bytes = static_cast<size_t>(std::filesystem::file_size(ruta));
+
+    Cronometro antes;
+    size_t lineasAntes = 0;
+    double suma = 0;
+    {
+        std::ifstream archivo(ruta, std::ios::binary);
+        std::string linea;
+        while (std::getline(archivo, linea)) {
+            if (linea.empty() || linea[0] == '#') continue;
+            std::vector<std::string> partes = dividirCadena(linea, '|');
+            if (partes.empty()) continue;
+            lineasAntes++;
+            try {
+                if (partes[0] == "CALIFICACION" && partes.size() >= 3) suma += std::stod(partes[2]);
+                else if (partes[0] == "PELICULA" && partes.size() >= 7) suma += std::stod(partes[2]) + std::stoi(partes[3]) + std::stoi(partes[6]);
+                else if (partes[0] == "SERIE" && partes.size() >= 8) suma += std::stod(partes[2]) + std::stoi(partes[3]) + std::stoi(partes[5]) + std::stoi(partes[6]);
+                else if (partes[0] == "USUARIO_CALIFICACION" && partes.size() >= 4) suma += std::stoi(partes[3]);
+            } catch (const std::exception&) {
+            }
+        }
+    }
+    double msAntes = antes.ms();
+
+    Cronometro ahora;
+    size_t lineasAhora = 0;
+    {
+        std::ifstream archivo(ruta, std::ios::binary);
+        LectorRegistros lector(archivo);
+        RegistroDatos registro;
+        while (lector.siguiente(registro)) {
+            OperacionDatos op = OperacionDatos::interpretar(registro);
+            suma += op.calificacion + op.duracion + op.anio + op.calificacionUsuario;
+            lineasAhora++;
+        }
+    }
+    double msAhora = ahora.ms();
+    sumidero = suma;
+
+    resultado("%.1f MB, %zu líneas (archivo en la caché del sistema)", bytes / (1024.0 * 1024.0), lineasAhora);
+    resultado("getline + dividirCadena: %10.1f ms  %8.1f MB/s", msAntes, megabytesPorSegundo(bytes, msAntes));
+    resultado("LectorRegistros:         %10.1f ms  %8.1f MB/s  (%.1fx)", msAhora,
+              megabytesPorSegundo(bytes, msAhora), msAntes / msAhora);
+    if (lineasAntes != lineasAhora) resultado("¡distinta cantidad de líneas: %zu vs %zu!", lineasAntes, lineasAhora);
+}
+
+// user-003: lectura por flujo vs archivo mapeado
+void medirMapeo() {
+    encabezado("user-003", "Interpretar el archivo de datos: ifstream vs mapeo en memoria");
+    const std::string& ruta = archivoDatos();
+    size_t bytes = static_cast<size_t>(std::filesystem::file_size(ruta));
+    double suma = 0;
+
+    Cronometro flujo;
+    {
+        std::ifstream archivo(ruta, std::ios::binary);
+        LectorRegistros lector(archivo);
+        RegistroDatos registro;
+        while (lector.siguiente(registro)) suma += OperacionDatos::interpretar(registro).calificacion;
+    }
+    double msFlujo = flujo.ms();
+
+    Cronometro mapeado;
+    {
+        ArchivoMapeado mapeo(ruta);
+        if (!mapeo.valido()) {
+            resultado("no se pudo mapear %s", ruta.c_str());
+            return;
+        }
+        LectorRegistros lector(mapeo.contenido());
+        RegistroDatos registro;
+        while (lector.siguiente(registro)) suma += OperacionDatos::interpretar(registro).calificacion;
+    }
+    double msMapeo = mapeado.ms();
+    sumidero = suma;
+
+    resultado("%.1f MB (archivo en la caché del sistema)", bytes / (1024.0 * 1024.0));
+    resultado("ifstream: %10.1f ms  %8.1f MB/s", msFlujo, megabytesPorSegundo(bytes, msFlujo));
+    resultado("mapeo:    %10.1f ms  %8.1f MB/s  (%.1fx)", msMapeo, megabytesPorSegundo(bytes, msMapeo),
+              msFlujo / msMapeo);
+}
+
+// user-007: recorridos sobre objetos vs sobre columnas
+void medirColumnas() {
+    encabezado("user-007", "Filtros por calificación y género: objetos en el heap vs columnas");
+    size_t n = escalar(5000000);
+    double msRangoAntes, msGeneroAntes, msRangoAhora, msGeneroAhora;
+    size_t enRango = 0, delGenero = 0;
+    {
+        auto catalogo = crearCatalogoAntiguo(n);
+        Cronometro rango;
+        std::vector<std::shared_ptr<VideoAntiguo>> filtrados;
+        for (const auto& video : catalogo) {
+            int calificacion = static_cast<int>(video->getCalificacion());
+            if (calificacion >= 7 && calificacion <= 8) filtrados.push_back(video);
+        }
+        msRangoAntes = rango.ms();
+        enRango = filtrados.size();
+
+        Cronometro genero;
+        filtrados.clear();
+        for (const auto& video : catalogo) {
+            if (video->getGenero() == "Fantasia") filtrados.push_back(video);
+        }
+        msGeneroAntes = genero.ms();
+        delGenero = filtrados.size();
+    }
+    {
+        auto catalogo = crearCatalogo(n);
+        const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+
+        Cronometro rango;
+        std::vector<uint64_t> bitmap;
+        ResumenCalificaciones resumen = filtrarCalificaciones(almacen.getCalificaciones(), 7, 9, bitmap);
+        msRangoAhora = rango.ms();
+        if (resumen.cuenta != enRango) resultado("¡el rango no coincide: %zu vs %zu!", resumen.cuenta, enRango);
+
+        Cronometro genero;
+        uint32_t fantasia = TablaCadenas::global().buscar("Fantasia");
+        const auto& generos = almacen.getGeneros();
+        std::vector<uint32_t> filas;
+        const auto& calificaciones = almacen.getCalificaciones();
+        for (uint32_t fila = 0; fila < generos.size(); fila++) {
+            if (generos[fila] == fantasia && !std::isnan(calificaciones[fila])) filas.push_back(fila);
+        }
+        msGeneroAhora = genero.ms();
+        if (filas.size() != delGenero) resultado("¡el género no coincide: %zu vs %zu!", filas.size(), delGenero);
+    }
+    resultado("%zu títulos", n);
+    resultado("rango 7-8, objetos:   %10.1f ms   columnas: %8.1f ms  (%.1fx)",
+              msRangoAntes, msRangoAhora, msRangoAntes / msRangoAhora);
+    resultado("género, objetos:      %10.1f ms   columnas: %8.1f ms  (%.1fx)",
+              msGeneroAntes, msGeneroAhora, msGeneroAntes / msGeneroAhora);
+}
+
+// user-008: memoria por título y costo de las estadísticas
+void medirInternado() {
+    encabezado("user-008", "Géneros y directores internados: memoria por título y estadísticas");
+    size_t n = escalar(1000000);
+
+    // Primero el catálogo actual y, sin liberarlo, el antiguo: así cada
+    // uno ocupa páginas nuevas y la diferencia de memoria residente es suya
+    bool almacenVacio = AlmacenCatalogo::global().getCalificaciones().empty();
+    size_t base = memoriaResidente();
+    auto catalogo = crearCatalogo(n);
+    size_t conAlmacen = memoriaResidente();
+    auto antiguo = crearCatalogoAntiguo(n);
+    size_t conAntiguo = memoriaResidente();
+
+    size_t cadenas = 0;
+    for (const auto& video : antiguo) cadenas += video->bytesCadenas();
+
+    Cronometro antes;
+    int totalPeliculas = 0;
+    double suma = 0;
+    std::map<std::string, int> generos, directores;
+    for (const auto& video : antiguo) {
+        if (video->getTipo() == "Pelicula") totalPeliculas++;
+        suma += video->getCalificacion();
+        generos[video->getGenero()]++;
+        directores[video->getDirector()]++;
+    }
+    auto masFrecuente = [](const std::map<std::string, int>& cuentas) {
+        return std::max_element(cuentas.begin(), cuentas.end(),
+                                [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+    };
+    std::string genero = masFrecuente(generos), director = masFrecuente(directores);
+    double msAntes = antes.ms();
+
+    Cronometro ahora;
+    const EstadisticasCatalogo& est = AlmacenCatalogo::global().getEstadisticas();
+    size_t peliculas = est.getTotal(AlmacenCatalogo::PELICULA);
+    double promedio = est.getPromedio();
+    uint32_t generoId = est.getGeneros().masFrecuente();
+    uint32_t directorId = est.getDirectores().masFrecuente();
+    double msAhora = ahora.ms();
+    sumidero = suma + promedio + peliculas + generoId + directorId + totalPeliculas;
+
+    resultado("%zu títulos", n);
+    if (!almacenVacio) {
+        resultado("memoria por título: se omite, el almacén ya tenía filas (correr \"internado\" sola)");
+    } else if (base && conAntiguo) {
+        resultado("memoria por título, objetos con cadenas: %6.0f B  (%.0f B en cadenas del heap)",
+                  static_cast<double>(conAntiguo - conAlmacen) / n, static_cast<double>(cadenas) / n);
+        resultado("memoria por título, almacén internado:   %6.0f B", static_cast<double>(conAlmacen - base) / n);
+    }
+    resultado("estadísticas con std::map<std::string,int>: %10.1f ms", msAntes);
+    resultado("estadísticas mantenidas (EstadisticasCatalogo): %7.4f ms", msAhora);
+    if (textoInternado(generoId) != genero) resultado("¡el género más popular no coincide!");
+}
+
+// user-009: núcleos de filtrado
+void medirNucleos() {
+    encabezado("user-009", "Filtro y agregación de calificaciones: ns por título de cada núcleo");
+    size_t n = escalar(10000000);
+    std::vector<float> calificaciones(n);
+    for (size_t i = 0; i < n; i++) calificaciones[i] = static_cast<float>(calificacionSintetica(i));
+    std::vector<uint64_t> bitmap((n + 63) / 64);
+
+    auto probar = [&](const char* nombre, NucleoFiltro nucleo) {
+        double mejor = std::numeric_limits<double>::infinity();
+        size_t cuenta = 0;
+        for (int vuelta = 0; vuelta < 5; vuelta++) {
+            std::fill(bitmap.begin(), bitmap.end(), 0);
+            ResumenCalificaciones resumen;
+            Cronometro c;
+            nucleo(calificaciones.data(), n, 7.0f, 9.0f, bitmap.data(), resumen);
+            mejor = std::min(mejor, c.ms());
+            cuenta = resumen.cuenta;
+        }
+        resultado("%-8s %8.2f ns/título  (%zu en rango)", nombre, mejor * 1e6 / n, cuenta);
+    };
+
+    resultado("%zu calificaciones", n);
+    probar("escalar", filtrarCalificacionesEscalar);
+#ifdef NUCLEOS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1")) probar("SSE4.1", filtrarCalificacionesSSE41);
+    if (__builtin_cpu_supports("avx2")) probar("AVX2", filtrarCalificacionesAVX2);
+#endif
+}
+
+// user-013: tira de portadas en frío (decodificar) y en caliente (miniaturas)
+void medirMiniaturas() {
+    encabezado("user-013", "Portadas de 5k títulos: decodificar vs miniaturas guardadas");
+    if (directorioPortadas.empty()) {
+        resultado("se omite: indicar un directorio con portadas .jpg/.png con --portadas=DIR");
+        return;
+    }
+    std::vector<std::filesystem::path> fuentes;
+    std::error_code ec;
+    for (const auto& entrada : std::filesystem::directory_iterator(directorioPortadas, ec)) {
+        std::string extension = entrada.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == ".jpg" || extension == ".png") fuentes.push_back(entrada.path());
+    }
+    if (fuentes.empty()) {
+        resultado("se omite: no hay portadas en %s", directorioPortadas.c_str());
+        return;
+    }
+
+    // Una copia por título, para que cada uno tenga su propia miniatura
+    size_t n = escalar(5000);
+    std::filesystem::path directorio = directorioTemporal / "portadas";
+    std::filesystem::create_directories(directorio);
+    std::vector<std::string> rutas;
+    for (size_t i = 0; i < n; i++) {
+        const auto& fuente = fuentes[i % fuentes.size()];
+        std::filesystem::path destino = directorio / ("portada" + std::to_string(i) + fuente.extension().string());
+        std::filesystem::copy_file(fuente, destino, std::filesystem::copy_options::overwrite_existing);
+        rutas.push_back(destino.string());
+    }
+
+    auto poblar = [&] {
+        Cronometro c;
+        for (const auto& ruta : rutas) delete CachePortadas::decodificar(ruta);
+        return c.ms();
+    };
+    double msFrio = poblar();
+    double msCaliente = poblar();
+    resultado("%zu portadas (%zu archivos distintos)", n, fuentes.size());
+    resultado("en frío (decodificar y reducir): %10.1f ms  (%.1f us/portada)", msFrio, msFrio * 1000 / n);
+    resultado("en caliente (miniaturas):        %10.1f ms  (%.1f us/portada)", msCaliente, msCaliente * 1000 / n);
+}
+
+// user-018: índice de calificaciones vs ordenar cada vez
+void medirIndiceCalificaciones() {
+    encabezado("user-018", "Consultas por calificación: std::sort/max_element vs índice ordenado");
+    size_t n = escalar(1000000);
+    auto catalogo = crearCatalogo(n);
+    const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+    const IndiceCalificaciones& indice = almacen.getIndiceCalificaciones();
+    auto mayor = [](const std::shared_ptr<Video>& a, const std::shared_ptr<Video>& b) {
+        return a->getCalificacion() > b->getCalificacion();
+    };
+
+    Cronometro ordenar;
+    auto copia = catalogo;
+    std::sort(copia.begin(), copia.end(), mayor);
+    double msOrdenar = ordenar.ms();
+
+    Cronometro maximo;
+    auto mejor = std::max_element(catalogo.begin(), catalogo.end(),
+                                  [](const auto& a, const auto& b) { return a->getCalificacion() < b->getCalificacion(); });
+    double msMaximo = maximo.ms();
+
+    Cronometro recorrerTodo;
+    size_t enRangoAntes = 0;
+    for (const auto& video : catalogo) {
+        int calificacion = static_cast<int>(video->getCalificacion());
+        if (calificacion >= 7 && calificacion <= 8) enRangoAntes++;
+    }
+    double msRangoAntes = recorrerTodo.ms();
+
+    Cronometro primero;
+    uint32_t filaMejor = indice.filaEn(0);
+    double msPrimero = primero.ms();
+
+    const size_t consultas = 1000;
+    Cronometro puestos;
+    size_t sumaPuestos = 0;
+    for (size_t i = 0; i < consultas; i++) sumaPuestos += almacen.puestoPorCalificacion(catalogo[mezclar(i) % n]->getId());
+    double msPuesto = puestos.ms() / consultas;
+
+    Cronometro rango;
+    size_t enRango = indice.contarRango(7, 9);
+    double msContar = rango.ms();
+    Cronometro recorrer;
+    size_t visitadas = 0;
+    indice.recorrerRango(7, 9, [&](uint32_t) { visitadas++; });
+    double msRecorrer = recorrer.ms();
+
+    Cronometro cambios;
+    for (size_t i = 0; i < consultas; i++) catalogo[mezclar(i + 7) % n]->setCalificacion(calificacionSintetica(i));
+    double msCambio = cambios.ms() / consultas;
+    sumidero = sumaPuestos + visitadas + filaMejor;
+
+    resultado("%zu títulos", n);
+    resultado("mejor calificado:  max_element %8.2f ms   índice %8.4f ms", msMaximo, msPrimero);
+    resultado("orden completo:    std::sort   %8.2f ms   índice: ya ordenado", msOrdenar);
+    resultado("puesto de un título:                      índice %8.4f ms", msPuesto);
+    resultado("rango 7-8 (%zu):   recorrido   %8.2f ms   contar %8.4f ms, recorrer %8.2f ms",
+              enRango, msRangoAntes, msContar, msRecorrer);
+    resultado("mantener el índice por cambio de calificación: %.4f ms", msCambio);
+    if (enRango != enRangoAntes || (*mejor)->getCalificacion() != almacen.calificacion(filaMejor)) {
+        resultado("¡el índice no coincide con el recorrido!");
+    }
+}
+
+// user-019: los K mejores con filtro
+void medirMejoresK() {
+    encabezado("user-019", "Top 50 por género: ordenar todo vs AlmacenCatalogo::mejores");
+    size_t n = escalar(1000000);
+    auto catalogo = crearCatalogo(n);
+    const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+    const size_t k = 50;
+
+    for (const char* genero : { "Fantasia", "Musical" }) {
+        Cronometro antes;
+        auto copia = catalogo;
+        std::sort(copia.begin(), copia.end(), [](const auto& a, const auto& b) {
+            return a->getCalificacion() > b->getCalificacion();
+        });
+        std::vector<std::shared_ptr<Video>> mejoresAntes;
+        for (const auto& video : copia) {
+            if (mejoresAntes.size() == k) break;
+            if (video->getGenero() == genero) mejoresAntes.push_back(video);
+        }
+        double msAntes = antes.ms();
+
+        AlmacenCatalogo::FiltroMejores filtro;
+        filtro.genero = TablaCadenas::global().buscar(genero);
+        Cronometro ahora;
+        std::vector<uint32_t> filas = almacen.mejores(k, filtro);
+        double msAhora = ahora.ms();
+
+        resultado("%-9s (%6d títulos): ordenar y filtrar %8.2f ms   mejores() %8.3f ms  (%zu resultados)",
+                  genero, almacen.getEstadisticas().getGeneros().getCuenta(filtro.genero),
+                  msAntes, msAhora, filas.size());
+        if (filas.size() != mejoresAntes.size()) resultado("¡distinta cantidad de resultados!");
+    }
+
+    Cronometro todos;
+    std::vector<uint32_t> filas = almacen.mejores(k, {});
+    resultado("sin filtro: mejores() %.3f ms", todos.ms());
+    sumidero = filas.size();
+}
+
+// user-020: ordenar y filtrar en paralelo
+void medirParalelo() {
+    encabezado("user-020", "Ordenar claves y filtrar: en serie vs en el pool compartido");
+    resultado("%zu hilos en el pool compartido", PoolHilos::compartido().getNumHilos());
+    for (size_t tamano : { size_t(1000000), size_t(10000000) }) {
+        size_t n = escalar(tamano);
+        std::vector<uint64_t> claves(n);
+        for (size_t i = 0; i < n; i++) claves[i] = mezclar(i);
+
+        auto copia = claves;
+        Cronometro serie;
+        std::sort(copia.begin(), copia.end());
+        double msSerie = serie.ms();
+
+        copia = claves;
+        Cronometro paralelo;
+        ordenarEnParalelo(copia, std::less<uint64_t>());
+        double msParalelo = paralelo.ms();
+        if (!std::is_sorted(copia.begin(), copia.end())) resultado("¡ordenarEnParalelo no ordenó!");
+
+        auto predicado = [&](size_t i) { return (claves[i] & 1023) < 100; };
+        Cronometro filtroSerie;
+        std::vector<uint32_t> posiciones;
+        for (size_t i = 0; i < n; i++) {
+            if (predicado(i)) posiciones.push_back(static_cast<uint32_t>(i));
+        }
+        double msFiltroSerie = filtroSerie.ms();
+        Cronometro filtroParalelo;
+        std::vector<uint32_t> enParalelo = filtrarEnParalelo(n, predicado);
+        double msFiltroParalelo = filtroParalelo.ms();
+        if (enParalelo != posiciones) resultado("¡filtrarEnParalelo no coincide!");
+
+        resultado("%9zu claves: std::sort %8.1f ms  paralelo %8.1f ms (%.1fx) | filtro %7.1f ms  paralelo %7.1f ms (%.1fx)",
+                  n, msSerie, msParalelo, msSerie / msParalelo,
+                  msFiltroSerie, msFiltroParalelo, msFiltroSerie / msFiltroParalelo);
+    }
+}
+
+// user-006: arranque en frío desde texto vs desde la instantánea binaria
+void medirArranque() {
+    encabezado("user-006", "Arranque en frío: catálogo e historial en texto vs instantánea .cat");
+    resultado("sin ventana: se mide hasta tener los videos, su índice y las calificaciones al día");
+    const std::string rutaDatos = (directorioTemporal / "arranque_catalogo.txt").string();
+    const std::string rutaHistorial = (directorioTemporal / "arranque_historial.txt").string();
+    const std::string rutaCat = rutaHistorial + ".cat";
+
+    auto indexar = [](const std::vector<std::shared_ptr<Video>>& videos, IndiceTitulos& indice) {
+        indice.reserve(videos.size());
+        for (const auto& video : videos) indice.emplace(video->getTitulo(), video);
+    };
+
+    for (size_t tamano : { size_t(10000), size_t(100000), size_t(1000000) }) {
+        size_t n = escalar(tamano);
+        {
+            auto catalogo = crearCatalogo(n);
+            std::string texto;
+            for (size_t i = 0; i < n; i++) {
+                char calificacion[8];
+                std::snprintf(calificacion, sizeof(calificacion), "%.1f", calificacionSintetica(i));
+                if (i % 5 == 4) {
+                    texto += "SERIE|" + tituloSintetico(i) + "|" + calificacion + "|12|" + generoSintetico(i) +
+                             "|3|36|" + directorSintetico(i) + "\n";
+                } else {
+                    texto += "PELICULA|" + tituloSintetico(i) + "|" + calificacion + "|95|" + generoSintetico(i) +
+                             "|" + directorSintetico(i) + "|" + std::to_string(anioSintetico(i)) + "\n";
+                }
+            }
+            std::ofstream(rutaDatos, std::ios::binary) << texto;
+            HistorialManager historial(rutaHistorial);
+            historial.leerEpoca();
+            historial.actualizarHistorialCompleto(catalogo);
+            InstantaneaCatalogo::guardar(rutaCat, catalogo, historial.getEpoca());
+        }
+
+        // Como antes de la instantánea: cada video sale de interpretar texto
+        double msTexto;
+        {
+            std::vector<std::shared_ptr<Video>> videos;
+            IndiceTitulos indice;
+            Cronometro cronometro;
+            HistorialManager historial(rutaHistorial);
+            ArchivoMapeado mapeo(rutaDatos);
+            LectorRegistros lector(mapeo.contenido());
+            RegistroDatos registro;
+            while (lector.siguiente(registro)) {
+                const auto& c = registro.campos;
+                if (registro.tipo() == "PELICULA") {
+                    videos.push_back(std::make_shared<Pelicula>(std::string(c[1]), convertirDouble(c[2]),
+                                                                convertirEntero(c[3]), std::string(c[4]),
+                                                                std::string(c[5]), convertirEntero(c[6])));
+                } else {
+                    videos.push_back(std::make_shared<Serie>(std::string(c[1]), convertirDouble(c[2]),
+                                                             convertirEntero(c[3]), std::string(c[4]),
+                                                             convertirEntero(c[5]), convertirEntero(c[6]),
+                                                             std::string(c[7])));
+                }
+            }
+            indexar(videos, indice);
+            historial.cargarHistorial(indice);
+            msTexto = cronometro.ms();
+        }
+
+        // Con la instantánea; "anterior" simula una compactación posterior
+        // a guardarla, que obliga a aplicar también el historial de texto
+        double msCat[2];
+        for (int anterior = 0; anterior < 2; anterior++) {
+            std::vector<std::shared_ptr<Video>> videos;
+            IndiceTitulos indice;
+            Cronometro cronometro;
+            HistorialManager historial(rutaHistorial);
+            uint64_t epoca = historial.leerEpoca() + anterior;
+            bool vigente = false;
+            if (!InstantaneaCatalogo::cargar(rutaCat, epoca, videos, vigente)) {
+                throw std::runtime_error("no se pudo cargar " + rutaCat);
+            }
+            indexar(videos, indice);
+            if (!vigente) historial.aplicarInstantanea(indice);
+            historial.reproducirBitacora(indice);
+            msCat[anterior] = cronometro.ms();
+        }
+
+        resultado("%8zu títulos: texto %8.1f ms | .cat %7.1f ms (%.1fx) | .cat + historial %7.1f ms (%.1fx)",
+                  n, msTexto, msCat[0], msTexto / msCat[0], msCat[1], msTexto / msCat[1]);
+    }
+}
+
+// user-025: títulos parecidos con el árbol, antes y después de editar
+void medirSimilitud() {
+    encabezado("user-025", "Títulos parecidos: recorrido completo vs árbol con filas editadas");
+    size_t n = escalar(1000000);
+    auto catalogo = crearCatalogo(n);
+    const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+    const size_t k = 20;
+    const size_t consultas = 50;
+    auto filaConsulta = [&](size_t j) { return catalogo[mezclar(j + 77) % n]->getId(); };
+
+    // Referencia: todas las filas comparadas con la consulta, en serie
+    auto recorrer = [&](uint32_t fila) {
+        RasgosVideo consulta = RasgosVideo::de(almacen, fila);
+        MasParecidos mejores(k);
+        const auto& calificaciones = almacen.getCalificaciones();
+        for (size_t i = 0; i < calificaciones.size(); i++) {
+            uint32_t otra = static_cast<uint32_t>(i);
+            if (otra == fila || std::isnan(calificaciones[i])) continue;
+            mejores.considerar(distanciaRasgos(consulta, RasgosVideo::de(almacen, otra)), otra);
+        }
+        std::vector<float> distancias;
+        for (const auto& par : mejores.ordenados()) distancias.push_back(par.first);
+        return distancias;
+    };
+
+    Cronometro recorrido;
+    for (size_t j = 0; j < consultas; j++) sumidero = recorrer(filaConsulta(j)).size();
+    double msRecorrido = recorrido.ms() / consultas;
+
+    MotorSimilitud motor;
+    Cronometro construccion;
+    motor.preparar();
+    double msCopia = construccion.ms();
+    for (bool listo = false; !listo; ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        motor.buscar(filaConsulta(0), 1, listo);
+    }
+    resultado("%zu títulos; árbol: %.1f ms copiando rasgos, %.1f ms hasta poder usarlo",
+              n, msCopia, construccion.ms());
+    resultado("%-30s %8.2f ms/consulta", "recorrido completo en serie:", msRecorrido);
+
+    auto medir = [&](const char* nombre) {
+        double msTotal = 0;
+        size_t conArbol = 0, distintas = 0;
+        for (size_t j = 0; j < consultas; j++) {
+            bool usoArbol = false;
+            Cronometro cronometro;
+            auto lista = motor.buscar(filaConsulta(j), k, usoArbol);
+            msTotal += cronometro.ms();
+            conArbol += usoArbol;
+            std::vector<float> distancias;
+            for (const auto& par : lista) distancias.push_back(par.first);
+            if (distancias != recorrer(filaConsulta(j))) distintas++;
+        }
+        resultado("%-30s %8.2f ms/consulta  (%zu de %zu con el árbol)", nombre, msTotal / consultas, conArbol, consultas);
+        if (distintas) resultado("¡%zu consultas distintas del recorrido completo!", distintas);
+    };
+
+    medir("árbol sin ediciones:");
+    catalogo[n / 2]->setCalificacion(9.9);
+    medir("árbol, 1 calificación:");
+
+    // Por debajo del límite con que MotorSimilitud pide otro árbol
+    size_t ediciones = std::max<size_t>(1, n / 512);
+    for (size_t j = 0; j < ediciones; j++) {
+        catalogo[mezclar(j + 991) % n]->setCalificacion(calificacionSintetica(j + 5));
+    }
+    std::string nombre = "árbol, " + std::to_string(ediciones) + " calificaciones:";
+    medir(nombre.c_str());
+}
+
+// user-004: importación en paralelo según el número de hilos
+void medirImportacion() {
+    encabezado("user-004", "Importar el archivo de datos: en serie vs importarEnParalelo con 1 a 32 hilos");
+    const std::string& ruta = archivoDatos();
+    ArchivoMapeado mapeo(ruta);
+    if (!mapeo.valido()) throw std::runtime_error("no se pudo mapear " + ruta);
+    std::string_view datos = mapeo.contenido();
+
+    // Lo que hace CatalogoApp::aplicarOperacion con calificaciones y videos
+    // nuevos, sin ventana ni índice de búsqueda
+    std::vector<std::shared_ptr<Video>> videos;
+    IndiceTitulos indice;
+    std::string clave;
+    size_t actualizadas = 0;
+    auto aplicar = [&](const OperacionDatos& op) {
+        RegistroDatos registro;
+        RegistroDatos::dividir(op.linea, registro);
+        const auto& c = registro.campos;
+        if (op.tipo != OperacionDatos::CALIFICACION && op.tipo != OperacionDatos::PELICULA &&
+            op.tipo != OperacionDatos::SERIE) {
+            return;
+        }
+        clave.assign(c[1]);
+        auto it = indice.find(clave);
+        if (op.tipo == OperacionDatos::CALIFICACION) {
+            if (it != indice.end()) {
+                it->second->setCalificacion(op.calificacion);
+                actualizadas++;
+            }
+            return;
+        }
+        if (it != indice.end()) return;
+        std::shared_ptr<Video> video;
+        if (op.tipo == OperacionDatos::PELICULA) {
+            video = std::make_shared<Pelicula>(clave, op.calificacion, op.duracion, std::string(c[4]),
+                                               std::string(c[5]), op.anio);
+        } else {
+            video = std::make_shared<Serie>(clave, op.calificacion, op.episodiosPorTemporada, std::string(c[4]),
+                                            op.numTemporadas, op.totalEpisodios, std::string(c[7]));
+        }
+        indice.emplace(clave, video);
+        videos.push_back(std::move(video));
+    };
+    auto enSerie = [&] {
+        LectorRegistros lector(datos);
+        RegistroDatos registro;
+        while (lector.siguiente(registro)) aplicar(OperacionDatos::interpretar(registro));
+    };
+
+    // La primera pasada agrega los videos y deja el archivo en la caché de
+    // páginas; las siguientes sólo actualizan, como reimportar el archivo
+    Cronometro primera;
+    enSerie();
+    double msPrimera = primera.ms();
+    actualizadas = 0;
+    Cronometro serie;
+    enSerie();
+    double msSerie = serie.ms();
+    size_t esperadas = actualizadas;
+
+    resultado("%.0f MB, %zu videos; %u núcleos; sizeof(OperacionDatos) = %zu B",
+              datos.size() / (1024.0 * 1024.0), videos.size(), std::thread::hardware_concurrency(),
+              sizeof(OperacionDatos));
+    resultado("primera pasada en serie (agrega videos): %8.1f ms", msPrimera);
+    resultado("en serie:     %8.1f ms  %7.1f MB/s", msSerie, megabytesPorSegundo(datos.size(), msSerie));
+    for (size_t hilos : { 1, 2, 4, 8, 16, 32 }) {
+        PoolHilos pool(hilos - 1);
+        actualizadas = 0;
+        Cronometro paralelo;
+        importarEnParalelo(datos, pool, aplicar);
+        double ms = paralelo.ms();
+        resultado("%2zu hilos:     %8.1f ms  %7.1f MB/s  (%.2fx)",
+                  hilos, ms, megabytesPorSegundo(datos.size(), ms), msSerie / ms);
+        if (actualizadas != esperadas) resultado("¡%zu calificaciones en vez de %zu!", actualizadas, esperadas);
+    }
+}
+
+struct Medicion {
+    const char* nombre;
+    void (*funcion)();
+};
+
+const Medicion MEDICIONES[] = {
+    { "titulos", medirIndiceTitulos },
+    { "importacion", medirImportacion },
+    { "lector", medirLectorRegistros },
+    { "mapeo", medirMapeo },
+    { "columnas", medirColumnas },
+    { "internado", medirInternado },
+    { "nucleos", medirNucleos },
+    { "miniaturas", medirMiniaturas },
+    { "calificaciones", medirIndiceCalificaciones },
+    { "mejores", medirMejoresK },
+    { "paralelo", medirParalelo },
+    { "arranque", medirArranque },
+    { "similitud", medirSimilitud },
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> elegidas;
+    for (int i = 1; i < argc; i++) {
+        std::string argumento = argv[i];
+        if (argumento.rfind("--escala=", 0) == 0) {
+            escala = std::atof(argumento.c_str() + 9);
+        } else if (argumento.rfind("--portadas=", 0) == 0) {
+            directorioPortadas = argumento.substr(11);
+        } else if (argumento == "--lista") {
+            for (const Medicion& medicion : MEDICIONES) std::printf("%s\n", medicion.nombre);
+            return 0;
+        } else {
+            elegidas.push_back(argumento);
+        }
+    }
+    if (escala <= 0) {
+        std::fprintf(stderr, "--escala debe ser mayor que 0\n");
+        return 1;
+    }
+
+    directorioTemporal = std::filesystem::temp_directory_path() /
+                         ("catalogo_bench_" + std::to_string(mezclar(static_cast<uint64_t>(time(0)))));
+    std::filesystem::create_directories(directorioTemporal);
+    std::printf("Escala %.3g, archivos temporales en %s\n", escala, directorioTemporal.string().c_str());
+
+    int estado = 0;
+    for (const Medicion& medicion : MEDICIONES) {
+        if (!elegidas.empty() && std::find(elegidas.begin(), elegidas.end(), medicion.nombre) == elegidas.end()) {
+            continue;
+        }
+        try {
+            medicion.funcion();
+        } catch (const std::exception& e) {
+            std::printf("  error: %s\n", e.what());
+            estado = 1;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(directorioTemporal, ec);
+    return estado;
+}
@@ -7,8 +7,9 @@
 #include <FL/Fl_Text_Display.H>
 #include <FL/Fl_Text_Buffer.H>
 #include <FL/Fl_Scroll.H>
-#include <FL/Fl_Pack.H>
 #include <FL/Fl_Spinner.H>
+#include <FL/Fl_Table_Row.H>
+#include <FL/fl_draw.H>
 #include <FL/fl_ask.H>
 #include <FL/Fl_JPEG_Image.H>
 #include <FL/Fl_PNG_Image.H>
@@ -21,17 +22,184 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <numeric>
+#include <random>
 #include <cstdlib>
 #include <iomanip>
 #include <set>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NUCLEOS_X86 1
+#include <immintrin.h>
+#endif
 
 // Declaración adelantada
 class CatalogoApp;
 
+// Pasa un carácter a minúsculas y sin acentos si es latino (Latin-1 y
+// Latin Extended-A); los demás se copian tal cual en UTF-8
+inline void plegarCaracter(uint32_t cp, std::string& salida) {
+    // '*' son letras que se escriben con dos ('æ', 'ß'...); '-' no son letras
+    static const char latin1[] = "aaaaaa*ceeeeiiiidnooooo-ouuuuy**aaaaaa*ceeeeiiiidnooooo-ouuuuy*y";
+    static const char latinExtendidoA[] =
+        "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii**jjkkkllllllllllnnnnnnnnnoooooo**"
+        "rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+    
+    if (cp < 0x80) {
+        salida += static_cast<char>(cp >= 'A' && cp <= 'Z' ? cp + 32 : cp);
+        return;
+    }
+    if (cp >= 0x300 && cp <= 0x36F) return;     // acentos sueltos (texto descompuesto)
+    
+    char base = 0;
+    if (cp >= 0xC0 && cp <= 0xFF) base = latin1[cp - 0xC0];
+    else if (cp >= 0x100 && cp <= 0x17F) base = latinExtendidoA[cp - 0x100];
+    
+    if (base == '*') {
+        switch (cp) {
+            case 0xC6: case 0xE6: salida += "ae"; break;
+            case 0xDE: case 0xFE: salida += "th"; break;
+            case 0xDF: salida += "ss"; break;
+            case 0x132: case 0x133: salida += "ij"; break;
+            default: salida += "oe"; break;     // Œ œ
+        }
+        return;
+    }
+    if (base && base != '-') {
+        salida += base;
+        return;
+    }
+    
+    if (cp < 0x800) {
+        salida += static_cast<char>(0xC0 | (cp >> 6));
+    } else if (cp < 0x10000) {
+        salida += static_cast<char>(0xE0 | (cp >> 12));
+        salida += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    } else {
+        salida += static_cast<char>(0xF0 | (cp >> 18));
+        salida += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        salida += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    }
+    salida += static_cast<char>(0x80 | (cp & 0x3F));
+}
+
+// Llama a funcion con cada carácter del texto leído como UTF-8; los bytes
+// que no forman UTF-8 válido se toman como Latin-1, que es como suelen
+// llegar los .txt guardados en Windows
+template <typename Funcion>
+inline void recorrerUtf8(std::string_view texto, Funcion&& funcion) {
+    for (size_t i = 0; i < texto.size(); ) {
+        unsigned char c = static_cast<unsigned char>(texto[i]);
+        if (c < 0x80) {
+            funcion(static_cast<uint32_t>(c));
+            i++;
+            continue;
+        }
+        
+        size_t largo = c >= 0xF5 ? 0 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC2 ? 2 : 0;
+        uint32_t cp = largo == 2 ? (c & 0x1F) : largo == 3 ? (c & 0x0F) : (c & 0x07);
+        bool valido = largo > 0 && i + largo <= texto.size();
+        for (size_t k = 1; valido && k < largo; k++) {
+            unsigned char siguiente = static_cast<unsigned char>(texto[i + k]);
+            valido = (siguiente & 0xC0) == 0x80;
+            cp = (cp << 6) | (siguiente & 0x3F);
+        }
+        
+        if (valido) {
+            funcion(cp);
+            i += largo;
+        } else {
+            funcion(static_cast<uint32_t>(c));
+            i++;
+        }
+    }
+}
+
+// Minúsculas y sin acentos
+inline std::string plegarTexto(std::string_view texto) {
+    std::string salida;
+    salida.reserve(texto.size());
+    recorrerUtf8(texto, [&](uint32_t cp) { plegarCaracter(cp, salida); });
+    return salida;
+}
+
+// Signos fuera de ASCII: los de Latin-1 (¿ ¡ « » ×...), la puntuación
+// general (— “ ” …) y la de CJK
+inline bool esSignoUnicode(uint32_t cp) {
+    return (cp >= 0x80 && cp <= 0xBF) || cp == 0xD7 || cp == 0xF7 ||
+           (cp >= 0x2000 && cp <= 0x206F) || (cp >= 0x3000 && cp <= 0x303F);
+}
+
+// Forma en que se comparan los textos al buscar: plegada y con cada tramo
+// de signos o espacios reducido a un solo espacio
+inline std::string normalizarBusqueda(std::string_view texto) {
+    std::string salida;
+    std::string plegado;
+    salida.reserve(texto.size());
+    bool separar = false;
+    recorrerUtf8(texto, [&](uint32_t cp) {
+        if (esSignoUnicode(cp)) {
+            separar = true;
+            return;
+        }
+        plegado.clear();
+        plegarCaracter(cp, plegado);
+        for (char c : plegado) {
+            bool letra = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || static_cast<unsigned char>(c) >= 0x80;
+            if (!letra) {
+                separar = true;
+                continue;
+            }
+            if (separar && !salida.empty()) salida += ' ';
+            separar = false;
+            salida += c;
+        }
+    });
+    return salida;
+}
+
 // Función para convertir título a nombre de archivo
 std::string tituloANombreArchivo(const std::string& titulo) {
-    std::string nombre = titulo;
+    std::string nombre = plegarTexto(titulo);   // "Extrañar" -> "extranar"
     std::string resultado;
     for (char c : nombre) {
         if (c >= 'A' && c <= 'Z') {
@@ -45,294 +213,3379 @@ std::string tituloANombreArchivo(const std::string& titulo) {
     return resultado;
 }
 
-// Clase base Video
-class Video {
-protected:
-    std::string titulo;
-    double calificacion;
-    std::string genero;
-    std::string director;
-    int anio;
-    std::string rutaPortada;
-    std::string basePath;
+// Pool de hilos compartido para trabajo paralelo (importación, filtros, etc.)
+class PoolHilos {
+private:
+    std::vector<std::thread> hilos;
+    std::deque<std::function<void()>> tareas;
+    std::mutex mutex;
+    std::condition_variable hayTareas;
+    bool detener;
+    
+    void trabajar() {
+        while (true) {
+            std::function<void()> tarea;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                hayTareas.wait(lock, [this] { return detener || !tareas.empty(); });
+                if (detener && tareas.empty()) return;
+                tarea = std::move(tareas.front());
+                tareas.pop_front();
+            }
+            tarea();
+        }
+    }
 
 public:
-    // Sobrecarga de operadores
-    Video& operator+=(double puntos) {
-        calificacion = std::min(10.0, calificacion + puntos);
-        return *this;
+    explicit PoolHilos(size_t numHilos) : detener(false) {
+        for (size_t i = 0; i < numHilos; i++) {
+            hilos.emplace_back([this] { trabajar(); });
+        }
+    }
+    
+    ~PoolHilos() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            detener = true;
+        }
+        hayTareas.notify_all();
+        for (auto& hilo : hilos) hilo.join();
+    }
+    
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+    
+    // Encola una tarea suelta sin esperar a que termine
+    void encolar(std::function<void()> tarea) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tareas.push_back(std::move(tarea));
+        }
+        hayTareas.notify_one();
+    }
+    
+    // Hilos que pueden trabajar a la vez, contando al que llama a paraCada
+    size_t getNumHilos() const { return hilos.size() + 1; }
+    
+    // funcion(i) para i en [0, n), repartido por demanda entre los hilos del
+    // pool. Se crea con lanzar y corre mientras quien la lanzó hace otra
+    // cosa; esperar() toma los índices que queden, espera a los demás hilos
+    // y relanza la primera excepción. El destructor descarta los índices
+    // que nadie empezó y espera a los que están en curso.
+    class Tanda {
+    private:
+        friend class PoolHilos;
+        
+        size_t n;
+        std::function<void(size_t)> funcion;
+        std::atomic<size_t> siguiente;
+        std::mutex mutexFin;
+        std::condition_variable terminado;
+        size_t pendientes;      // tareas encoladas en el pool que no terminaron
+        std::exception_ptr error;
+        
+        Tanda(size_t cuantos, std::function<void(size_t)> f)
+            : n(cuantos), funcion(std::move(f)), siguiente(0), pendientes(0) {}
+        
+        void recorrer() {
+            try {
+                for (size_t i = siguiente++; i < n; i = siguiente++) funcion(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutexFin);
+                if (!error) error = std::current_exception();
+                siguiente = n;
+            }
+        }
+        
+        void terminar() {
+            recorrer();
+            std::unique_lock<std::mutex> lock(mutexFin);
+            terminado.wait(lock, [this] { return pendientes == 0; });
+        }
+    
+    public:
+        ~Tanda() {
+            siguiente = n;
+            terminar();
+        }
+        
+        Tanda(const Tanda&) = delete;
+        Tanda& operator=(const Tanda&) = delete;
+        
+        void esperar() {
+            terminar();
+            std::lock_guard<std::mutex> lock(mutexFin);
+            if (error) std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    };
+    
+    std::unique_ptr<Tanda> lanzar(size_t n, std::function<void(size_t)> funcion) {
+        std::unique_ptr<Tanda> tanda(new Tanda(n, std::move(funcion)));
+        size_t tareasPool = std::min(n, hilos.size());
+        if (tareasPool == 0) return tanda;
+        tanda->pendientes = tareasPool;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t t = 0; t < tareasPool; t++) {
+                tareas.emplace_back([t = tanda.get()] {
+                    t->recorrer();
+                    std::lock_guard<std::mutex> lockFin(t->mutexFin);
+                    if (--t->pendientes == 0) t->terminado.notify_one();
+                });
+            }
+        }
+        hayTareas.notify_all();
+        return tanda;
+    }
+    
+    // Ejecuta funcion(i) para i en [0, n) y espera a que terminen todas.
+    // El hilo que llama también trabaja; la primera excepción se relanza.
+    void paraCada(size_t n, const std::function<void(size_t)>& funcion) {
+        if (n == 0) return;
+        if (n == 1 || hilos.empty()) {
+            for (size_t i = 0; i < n; i++) funcion(i);
+            return;
+        }
+        lanzar(n, funcion)->esperar();
+    }
+    
+    // Por debajo de este número de elementos los recorridos van en serie:
+    // repartirlos entre hilos cuesta más de lo que se gana
+    static constexpr size_t UMBRAL_PARALELO = 1 << 15;
+    
+    // En cuántas partes conviene dividir n elementos. Se hacen más partes que
+    // hilos para que, como paraCada reparte por demanda, el que termina antes
+    // tome la siguiente en vez de esperar al más lento.
+    size_t partesPara(size_t n) const {
+        if (n < UMBRAL_PARALELO || hilos.empty()) return 1;
+        return std::min(getNumHilos() * 4, n / (UMBRAL_PARALELO / 2));
+    }
+    
+    // Ejecuta funcion(parte, desde, hasta) sobre partes contiguas de [0, n)
+    void paraRangos(size_t n, const std::function<void(size_t, size_t, size_t)>& funcion) {
+        size_t partes = partesPara(n);
+        paraCada(partes, [&](size_t p) { funcion(p, n * p / partes, n * (p + 1) / partes); });
+    }
+    
+    static PoolHilos& compartido() {
+        static PoolHilos pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
     }
+};
 
-    Video& operator-=(double puntos) {
-        calificacion = std::max(0.0, calificacion - puntos);
-        return *this;
+// Posiciones en [0, n) que cumplen el predicado, en orden. Cada parte llena
+// su propio búfer y al final se concatenan en orden de parte.
+template <typename Predicado>
+std::vector<uint32_t> filtrarEnParalelo(size_t n, Predicado predicado) {
+    PoolHilos& pool = PoolHilos::compartido();
+    std::vector<std::vector<uint32_t>> parciales(pool.partesPara(n));
+    pool.paraRangos(n, [&](size_t parte, size_t desde, size_t hasta) {
+        for (size_t i = desde; i < hasta; i++) {
+            if (predicado(i)) parciales[parte].push_back(static_cast<uint32_t>(i));
+        }
+    });
+    if (parciales.size() == 1) return std::move(parciales[0]);
+    
+    std::vector<size_t> inicios(parciales.size() + 1, 0);
+    for (size_t p = 0; p < parciales.size(); p++) inicios[p + 1] = inicios[p] + parciales[p].size();
+    std::vector<uint32_t> posiciones(inicios.back());
+    pool.paraCada(parciales.size(), [&](size_t p) {
+        std::copy(parciales[p].begin(), parciales[p].end(), posiciones.begin() + inicios[p]);
+    });
+    return posiciones;
+}
+
+// Cuántos elementos de a salen entre los primeros d al mezclar a y b con
+// std::merge (que ante empates toma primero de a)
+template <typename T, typename Comparador>
+size_t corteMezcla(const T* a, size_t n, const T* b, size_t m, size_t d, Comparador comparador) {
+    size_t bajo = d > m ? d - m : 0;
+    size_t alto = std::min(d, n);
+    while (bajo < alto) {
+        size_t i = bajo + (alto - bajo) / 2;
+        size_t antes = std::lower_bound(b, b + m, a[i], comparador) - b;
+        if (i + antes < d) bajo = i + 1; else alto = i;
+    }
+    return bajo;
+}
+
+// Ordenamiento por mezcla en paralelo. Cada parte se ordena por separado y
+// luego se mezclan de a pares, alternando entre datos y un arreglo auxiliar.
+// Cada mezcla se corta a su vez en tramos de salida independientes, así las
+// últimas rondas, con pocos pares, siguen usando todos los hilos. No es
+// estable: pensado para claves sin repetidos.
+template <typename T, typename Comparador>
+void ordenarEnParalelo(std::vector<T>& datos, Comparador comparador) {
+    PoolHilos& pool = PoolHilos::compartido();
+    const size_t n = datos.size();
+    size_t partes = pool.partesPara(n);
+    if (partes == 1) {
+        std::sort(datos.begin(), datos.end(), comparador);
+        return;
+    }
+    
+    std::vector<size_t> cortes(partes + 1);
+    for (size_t p = 0; p <= partes; p++) cortes[p] = n * p / partes;
+    pool.paraCada(partes, [&](size_t p) {
+        std::sort(datos.begin() + cortes[p], datos.begin() + cortes[p + 1], comparador);
+    });
+    
+    std::vector<T> auxiliar(n);
+    T* origen = datos.data();
+    T* destino = auxiliar.data();
+    for (size_t ancho = 1; ancho < partes; ancho *= 2) {
+        size_t pares = (partes + 2 * ancho - 1) / (2 * ancho);
+        size_t tramos = std::max<size_t>(1, pool.partesPara(n) / pares);
+        pool.paraCada(pares * tramos, [&](size_t tarea) {
+            size_t par = tarea / tramos;
+            size_t tramo = tarea % tramos;
+            size_t inicio = cortes[par * 2 * ancho];
+            size_t medio = cortes[std::min(partes, par * 2 * ancho + ancho)];
+            size_t fin = cortes[std::min(partes, par * 2 * ancho + 2 * ancho)];
+            const T* a = origen + inicio;
+            const T* b = origen + medio;
+            size_t n1 = medio - inicio;
+            size_t n2 = fin - medio;
+            size_t d1 = (n1 + n2) * tramo / tramos;
+            size_t d2 = (n1 + n2) * (tramo + 1) / tramos;
+            size_t i1 = corteMezcla(a, n1, b, n2, d1, comparador);
+            size_t i2 = corteMezcla(a, n1, b, n2, d2, comparador);
+            std::merge(a + i1, a + i2, b + (d1 - i1), b + (d2 - i2), destino + inicio + d1, comparador);
+        });
+        std::swap(origen, destino);
+    }
+    if (origen != datos.data()) datos.swap(auxiliar);
+}
+
+// Resultado de filtrar una columna de calificaciones: cuántas pasaron el
+// filtro y su suma, mínimo, máximo e histograma por parte entera (0..10)
+struct ResumenCalificaciones {
+    size_t cuenta = 0;
+    double suma = 0;
+    float minimo = std::numeric_limits<float>::infinity();
+    float maximo = -std::numeric_limits<float>::infinity();
+    uint32_t histograma[11] = {};
+    
+    void agregar(float x) {
+        cuenta++;
+        suma += x;
+        minimo = std::min(minimo, x);
+        maximo = std::max(maximo, x);
+        int cubeta = static_cast<int>(x);
+        histograma[std::min(10, std::max(0, cubeta))]++;
     }
+};
 
-    Video(const std::string& t, double cal, const std::string& g, 
-          const std::string& dir, int a)
-        : titulo(t), calificacion(cal), genero(g), director(dir), 
-          anio(a), basePath(".\\") {
-        std::string nombreArchivo = tituloANombreArchivo(titulo);
-        rutaPortada = basePath + "portadas\\" + nombreArchivo + ".jpg";
+// Núcleos de filtrado: marcan en 'bitmap' (ya en cero) los valores en
+// [minimo, maximo) y acumulan el resumen en una sola pasada. Los NaN (filas
+// libres del almacén) nunca pasan el filtro.
+using NucleoFiltro = void (*)(const float*, size_t, float, float, uint64_t*, ResumenCalificaciones&);
+
+inline void filtrarCalificacionesEscalar(const float* datos, size_t n, float minimo, float maximo,
+                                         uint64_t* bitmap, ResumenCalificaciones& resumen) {
+    for (size_t i = 0; i < n; i++) {
+        float x = datos[i];
+        if (x >= minimo && x < maximo) {
+            bitmap[i / 64] |= uint64_t(1) << (i % 64);
+            resumen.agregar(x);
+        }
     }
+}
+
+#ifdef NUCLEOS_X86
+__attribute__((target("sse4.1")))
+inline void filtrarCalificacionesSSE41(const float* datos, size_t n, float minimo, float maximo,
+                                       uint64_t* bitmap, ResumenCalificaciones& resumen) {
+    const __m128 vMin = _mm_set1_ps(minimo);
+    const __m128 vMax = _mm_set1_ps(maximo);
+    const __m128 vInf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 vMenosInf = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+    __m128 acumMin = vInf, acumMax = vMenosInf;
+    __m128d acumSuma = _mm_setzero_pd();
+    alignas(16) int32_t partes[4];
+    
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(datos + i);
+        __m128 m = _mm_and_ps(_mm_cmpge_ps(x, vMin), _mm_cmplt_ps(x, vMax));
+        unsigned mascara = static_cast<unsigned>(_mm_movemask_ps(m));
+        if (!mascara) continue;
+        bitmap[i / 64] |= uint64_t(mascara) << (i % 64);
         
-    virtual ~Video() = default;
+        acumMin = _mm_min_ps(acumMin, _mm_blendv_ps(vInf, x, m));
+        acumMax = _mm_max_ps(acumMax, _mm_blendv_ps(vMenosInf, x, m));
+        __m128 seleccion = _mm_and_ps(x, m);
+        acumSuma = _mm_add_pd(acumSuma, _mm_cvtps_pd(seleccion));
+        acumSuma = _mm_add_pd(acumSuma, _mm_cvtps_pd(_mm_movehl_ps(seleccion, seleccion)));
         
-    // Función friend para operator<<
-    friend std::ostream& operator<<(std::ostream& os, const Video& video) {
-        os << video.getInfo();
-        return os;
+        resumen.cuenta += __builtin_popcount(mascara);
+        _mm_store_si128(reinterpret_cast<__m128i*>(partes), _mm_cvttps_epi32(x));
+        for (unsigned b = mascara; b; b &= b - 1) {
+            int cubeta = partes[__builtin_ctz(b)];
+            resumen.histograma[std::min(10, std::max(0, cubeta))]++;
+        }
     }
     
-    virtual std::string getTipo() const = 0;
-    virtual std::string getInfo() const = 0;
-    virtual std::string getRutaVideo() const = 0;
+    alignas(16) float mins[4], maxs[4];
+    alignas(16) double sumas[2];
+    _mm_store_ps(mins, acumMin);
+    _mm_store_ps(maxs, acumMax);
+    _mm_store_pd(sumas, acumSuma);
+    for (int k = 0; k < 4; k++) {
+        resumen.minimo = std::min(resumen.minimo, mins[k]);
+        resumen.maximo = std::max(resumen.maximo, maxs[k]);
+    }
+    resumen.suma += sumas[0] + sumas[1];
     
-    std::string getTitulo() const { return titulo; }
-    std::string getGenero() const { return genero; }
-    std::string getRutaPortada() const { return rutaPortada; }
-    double getCalificacion() const { return calificacion; }
-    std::string getDirector() const { return director; }
-    int getAnio() const { return anio; }
+    for (; i < n; i++) {
+        float x = datos[i];
+        if (x >= minimo && x < maximo) {
+            bitmap[i / 64] |= uint64_t(1) << (i % 64);
+            resumen.agregar(x);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+inline void filtrarCalificacionesAVX2(const float* datos, size_t n, float minimo, float maximo,
+                                      uint64_t* bitmap, ResumenCalificaciones& resumen) {
+    const __m256 vMin = _mm256_set1_ps(minimo);
+    const __m256 vMax = _mm256_set1_ps(maximo);
+    const __m256 vInf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    const __m256 vMenosInf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    __m256 acumMin = vInf, acumMax = vMenosInf;
+    __m256d acumSuma = _mm256_setzero_pd();
+    alignas(32) int32_t partes[8];
     
-    void actualizarCalificacion(int nuevaCalificacion) {
-        calificacion = (calificacion + nuevaCalificacion) / 2.0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(datos + i);
+        __m256 m = _mm256_and_ps(_mm256_cmp_ps(x, vMin, _CMP_GE_OQ), _mm256_cmp_ps(x, vMax, _CMP_LT_OQ));
+        unsigned mascara = static_cast<unsigned>(_mm256_movemask_ps(m));
+        if (!mascara) continue;
+        bitmap[i / 64] |= uint64_t(mascara) << (i % 64);
+        
+        acumMin = _mm256_min_ps(acumMin, _mm256_blendv_ps(vInf, x, m));
+        acumMax = _mm256_max_ps(acumMax, _mm256_blendv_ps(vMenosInf, x, m));
+        __m256 seleccion = _mm256_and_ps(x, m);
+        acumSuma = _mm256_add_pd(acumSuma, _mm256_cvtps_pd(_mm256_castps256_ps128(seleccion)));
+        acumSuma = _mm256_add_pd(acumSuma, _mm256_cvtps_pd(_mm256_extractf128_ps(seleccion, 1)));
+        
+        resumen.cuenta += __builtin_popcount(mascara);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(partes), _mm256_cvttps_epi32(x));
+        for (unsigned b = mascara; b; b &= b - 1) {
+            int cubeta = partes[__builtin_ctz(b)];
+            resumen.histograma[std::min(10, std::max(0, cubeta))]++;
+        }
     }
     
-    void setCalificacion(double cal) {
-        calificacion = cal;
+    alignas(32) float mins[8], maxs[8];
+    alignas(32) double sumas[4];
+    _mm256_store_ps(mins, acumMin);
+    _mm256_store_ps(maxs, acumMax);
+    _mm256_store_pd(sumas, acumSuma);
+    for (int k = 0; k < 8; k++) {
+        resumen.minimo = std::min(resumen.minimo, mins[k]);
+        resumen.maximo = std::max(resumen.maximo, maxs[k]);
     }
+    resumen.suma += sumas[0] + sumas[1] + sumas[2] + sumas[3];
     
-    void setGenero(const std::string& g) {
-        genero = g;
+    for (; i < n; i++) {
+        float x = datos[i];
+        if (x >= minimo && x < maximo) {
+            bitmap[i / 64] |= uint64_t(1) << (i % 64);
+            resumen.agregar(x);
+        }
+    }
+}
+#endif
+
+// Elige el núcleo según las capacidades de la CPU en tiempo de ejecución
+inline NucleoFiltro seleccionarNucleoFiltro() {
+#ifdef NUCLEOS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return filtrarCalificacionesAVX2;
+    if (__builtin_cpu_supports("sse4.1")) return filtrarCalificacionesSSE41;
+#endif
+    return filtrarCalificacionesEscalar;
+}
+
+// Filtra toda la columna al rango [minimo, maximo); bitmap queda indexado por fila
+inline ResumenCalificaciones filtrarCalificaciones(const std::vector<float>& columna,
+                                                   float minimo, float maximo,
+                                                   std::vector<uint64_t>& bitmap) {
+    static const NucleoFiltro nucleo = seleccionarNucleoFiltro();
+    ResumenCalificaciones resumen;
+    bitmap.assign((columna.size() + 63) / 64, 0);
+    nucleo(columna.data(), columna.size(), minimo, maximo, bitmap.data(), resumen);
+    return resumen;
+}
+
+inline bool bitActivo(const std::vector<uint64_t>& bitmap, uint32_t i) {
+    return (bitmap[i / 64] >> (i % 64)) & 1;
+}
+
+// Tabla de cadenas internadas: cada texto distinto (género, director, tipo)
+// recibe un id pequeño; el texto solo se consulta para mostrarlo
+class TablaCadenas {
+private:
+    std::vector<std::string> textos;
+    std::unordered_map<std::string, uint32_t> ids;
+
+public:
+    uint32_t internar(const std::string& texto) {
+        auto it = ids.find(texto);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(textos.size());
+        textos.push_back(texto);
+        ids.emplace(texto, id);
+        return id;
     }
     
-    bool existePortada() const {
-        std::ifstream file(rutaPortada);
-        return file.good();
+    // Id de un texto ya internado, o NINGUNO si nunca se vio
+    uint32_t buscar(const std::string& texto) const {
+        auto it = ids.find(texto);
+        return it != ids.end() ? it->second : NINGUNO;
     }
     
-    std::string getRutaPortadaODefault() const {
-        if (existePortada()) {
-            return rutaPortada;
+    const std::string& texto(uint32_t id) const { return textos[id]; }
+    size_t size() const { return textos.size(); }
+    
+    static constexpr uint32_t NINGUNO = UINT32_MAX;
+    
+    static TablaCadenas& global() {
+        static TablaCadenas tabla;
+        return tabla;
+    }
+};
+
+inline uint32_t internar(const std::string& texto) {
+    return TablaCadenas::global().internar(texto);
+}
+
+inline const std::string& textoInternado(uint32_t id) {
+    return TablaCadenas::global().texto(id);
+}
+
+// Cuenta cuántas filas tiene cada id internado y sabe en O(1) cuál es el
+// más frecuente. Las cubetas agrupan los ids por cuenta, ordenados por
+// nombre: ante un empate gana el nombre menor, como al recorrer un std::map.
+class ContadorFrecuencias {
+private:
+    struct PorNombre {
+        bool operator()(uint32_t a, uint32_t b) const {
+            const std::string& na = textoInternado(a);
+            const std::string& nb = textoInternado(b);
+            return na != nb ? na < nb : a < b;
         }
-        return basePath + "portadas\\default.jpg";
+    };
+    
+    std::vector<int> cuentas;
+    std::vector<std::set<uint32_t, PorNombre>> cubetas;
+    int maximo = 0;
+
+public:
+    void incrementar(uint32_t id) {
+        if (id >= cuentas.size()) cuentas.resize(id + 1, 0);
+        int c = cuentas[id]++;
+        if (c > 0) cubetas[c].erase(id);
+        if (cubetas.size() <= static_cast<size_t>(c + 1)) cubetas.resize(c + 2);
+        cubetas[c + 1].insert(id);
+        maximo = std::max(maximo, c + 1);
+    }
+    
+    void decrementar(uint32_t id) {
+        int c = cuentas[id]--;
+        cubetas[c].erase(id);
+        if (c > 1) cubetas[c - 1].insert(id);
+        if (c == maximo && cubetas[c].empty()) maximo--;
+    }
+    
+    int getMaximo() const { return maximo; }
+    
+    int getCuenta(uint32_t id) const { return id < cuentas.size() ? cuentas[id] : 0; }
+    
+    uint32_t masFrecuente() const {
+        return maximo > 0 ? *cubetas[maximo].begin() : TablaCadenas::NINGUNO;
     }
+};
 
-    // Sobrecarga de operadores de comparación
-    bool operator<(const Video& other) const {
-        return calificacion < other.calificacion;
+// Estadísticas del catálogo mantenidas en cada alta, baja o cambio de fila,
+// de modo que consultarlas cuesta O(1) sin importar el tamaño del catálogo
+class EstadisticasCatalogo {
+private:
+    size_t porTipo[2] = {0, 0};
+    double sumaCalificaciones = 0;
+    ContadorFrecuencias generos;
+    ContadorFrecuencias directores;
+
+public:
+    void agregar(uint8_t tipo, float calificacion, uint32_t genero, uint32_t director) {
+        porTipo[tipo]++;
+        sumaCalificaciones += calificacion;
+        generos.incrementar(genero);
+        directores.incrementar(director);
+    }
+    
+    void quitar(uint8_t tipo, float calificacion, uint32_t genero, uint32_t director) {
+        porTipo[tipo]--;
+        sumaCalificaciones -= calificacion;
+        generos.decrementar(genero);
+        directores.decrementar(director);
+    }
+    
+    void cambiarCalificacion(float anterior, float nueva) {
+        sumaCalificaciones += static_cast<double>(nueva) - anterior;
+    }
+    
+    void cambiarGenero(uint32_t anterior, uint32_t nuevo) {
+        if (anterior == nuevo) return;
+        generos.incrementar(nuevo);
+        generos.decrementar(anterior);
     }
+    
+    size_t getTotal(uint8_t tipo) const { return porTipo[tipo]; }
+    size_t getTotal() const { return porTipo[0] + porTipo[1]; }
+    double getPromedio() const { return getTotal() ? sumaCalificaciones / getTotal() : 0; }
+    const ContadorFrecuencias& getGeneros() const { return generos; }
+    const ContadorFrecuencias& getDirectores() const { return directores; }
+};
 
-    bool operator>(const Video& other) const {
-        return calificacion > other.calificacion;
+// Episodios de una serie con su distribución real por temporadas, cargados
+// con registros EPISODIO. Van en un arreglo plano ordenado por (temporada,
+// número), con el inicio de cada temporada en inicioTemporada, así que ir a
+// un episodio es O(1). Las rutas que no siguen el nombre por defecto se
+// guardan juntas en un solo texto, terminadas en '\0'. Cada episodio ocupa
+// 12 bytes: una serie de 5000 episodios cabe en unos 60 KB.
+class EpisodiosSerie {
+public:
+    static constexpr uint32_t SIN_RUTA = UINT32_MAX;
+    static constexpr int MAXIMO = 65535;     // temporada, número y duración
+    
+    struct Entrada {
+        uint16_t temporada;
+        uint16_t numero;
+        uint16_t duracion;   // minutos; 0 si no se conoce
+        uint8_t visto;
+        uint8_t reservado;
+        uint32_t ruta;       // desplazamiento en rutas, o SIN_RUTA
+    };
+
+private:
+    std::vector<Entrada> entradas;
+    std::vector<uint32_t> inicioTemporada;  // [t] = primer episodio de la temporada t + 1
+    std::string rutas;
+    
+    static bool antes(const Entrada& e, int temporada, int numero) {
+        return e.temporada != temporada ? e.temporada < temporada : e.numero < numero;
+    }
+    
+    uint32_t guardarRuta(std::string_view ruta) {
+        uint32_t desplazamiento = static_cast<uint32_t>(rutas.size());
+        rutas.append(ruta.data(), ruta.size());
+        rutas.push_back('\0');
+        return desplazamiento;
     }
 
-    bool operator==(const Video& other) const {
-        return titulo == other.titulo;
+public:
+    // Agrega un episodio o, si ya estaba, actualiza sus datos. Lanza
+    // std::out_of_range si temporada o número no están en [1, MAXIMO].
+    void agregar(int temporada, int numero, int duracion, std::string_view ruta, bool visto) {
+        if (temporada < 1 || temporada > MAXIMO || numero < 1 || numero > MAXIMO) {
+            throw std::out_of_range("episodio");
+        }
+        Entrada entrada = {};
+        entrada.temporada = static_cast<uint16_t>(temporada);
+        entrada.numero = static_cast<uint16_t>(numero);
+        entrada.duracion = static_cast<uint16_t>(std::max(0, std::min(duracion, MAXIMO)));
+        entrada.visto = visto ? 1 : 0;
+        entrada.ruta = SIN_RUTA;
+        
+        // Lo normal es que lleguen en orden: se agregan al final
+        size_t pos = entradas.size();
+        if (!entradas.empty() && !antes(entradas.back(), temporada, numero)) {
+            auto it = std::lower_bound(entradas.begin(), entradas.end(), entrada,
+                [](const Entrada& e, const Entrada& buscada) {
+                    return antes(e, buscada.temporada, buscada.numero);
+                });
+            pos = it - entradas.begin();
+            if (it->temporada == temporada && it->numero == numero) {
+                // Repetido: la ruta anterior se reutiliza si no cambió o si
+                // la nueva cabe en su lugar, para no hacer crecer rutas
+                entrada.ruta = it->ruta;
+                if (ruta.empty()) {
+                    entrada.ruta = SIN_RUTA;
+                } else if (it->ruta == SIN_RUTA || ruta.size() > this->ruta(pos).size()) {
+                    entrada.ruta = guardarRuta(ruta);
+                } else if (ruta != this->ruta(pos)) {
+                    std::copy(ruta.begin(), ruta.end(), rutas.begin() + it->ruta);
+                    rutas[it->ruta + ruta.size()] = '\0';
+                }
+                *it = entrada;
+                return;
+            }
+        }
+        if (!ruta.empty()) entrada.ruta = guardarRuta(ruta);
+        entradas.insert(entradas.begin() + pos, entrada);
+        
+        while (inicioTemporada.size() <= static_cast<size_t>(temporada)) {
+            inicioTemporada.push_back(static_cast<uint32_t>(entradas.size() - 1));
+        }
+        for (size_t t = temporada; t < inicioTemporada.size(); t++) inicioTemporada[t]++;
+    }
+    
+    size_t size() const { return entradas.size(); }
+    bool empty() const { return entradas.empty(); }
+    const Entrada& operator[](size_t i) const { return entradas[i]; }
+    const std::vector<Entrada>& getEntradas() const { return entradas; }
+    int getNumTemporadas() const { return inicioTemporada.empty() ? 0 : static_cast<int>(inicioTemporada.size() - 1); }
+    
+    // Posición del primer episodio de la temporada (size() si no hay más)
+    size_t primeroDe(int temporada) const {
+        if (temporada < 1) return 0;
+        if (static_cast<size_t>(temporada) >= inicioTemporada.size()) return entradas.size();
+        return inicioTemporada[temporada - 1];
     }
+    
+    // Posición del episodio, o -1. Si la temporada no tiene huecos en la
+    // numeración se calcula directamente; si no, se busca dentro de ella.
+    long buscar(int temporada, int numero) const {
+        size_t desde = primeroDe(temporada);
+        size_t hasta = primeroDe(temporada + 1);
+        if (numero < 1 || desde >= hasta) return -1;
+        size_t directo = desde + static_cast<size_t>(numero - 1);
+        if (directo < hasta && entradas[directo].numero == numero) return static_cast<long>(directo);
+        auto it = std::lower_bound(entradas.begin() + desde, entradas.begin() + hasta, numero,
+            [](const Entrada& e, int n) { return e.numero < n; });
+        return it != entradas.begin() + hasta && it->numero == numero ? it - entradas.begin() : -1;
+    }
+    
+    // Ruta guardada del episodio; vacía si usa la de por defecto
+    std::string_view ruta(size_t i) const {
+        return entradas[i].ruta == SIN_RUTA ? std::string_view() : std::string_view(rutas.c_str() + entradas[i].ruta);
+    }
+    
+    void setVisto(size_t i, bool visto) { entradas[i].visto = visto ? 1 : 0; }
+    
+    size_t bytesUsados() const {
+        return entradas.capacity() * sizeof(Entrada) + inicioTemporada.capacity() * sizeof(uint32_t) +
+               rutas.capacity();
+    }
+};
 
-    bool operator!=(const Video& other) const {
-        return !(*this == other);
+// Filas ordenadas por calificación, de mayor a menor (a igual calificación,
+// por fila). Es un árbol con estadísticas de orden, así que el mejor, los K
+// mejores, la posición de un título y cuántos caen en un rango salen en
+// O(log n) sin ordenar nada. Las filas libres (NaN) no entran.
+class IndiceCalificaciones {
+public:
+    using Clave = std::pair<float, uint32_t>;   // (calificación, fila)
+    
+    struct MayorPrimero {
+        bool operator()(const Clave& a, const Clave& b) const {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        }
+    };
+
+private:
+    using Arbol = __gnu_pbds::tree<Clave, __gnu_pbds::null_type, MayorPrimero,
+                                   __gnu_pbds::rb_tree_tag,
+                                   __gnu_pbds::tree_order_statistics_node_update>;
+    Arbol arbol;
+    
+    // Clave que queda justo antes de la primera fila con calificación < valor
+    static Clave cota(float valor) { return { valor, UINT32_MAX }; }
+
+public:
+    void agregar(uint32_t fila, float calificacion) {
+        if (!std::isnan(calificacion)) arbol.insert({ calificacion, fila });
+    }
+    
+    void quitar(uint32_t fila, float calificacion) {
+        if (!std::isnan(calificacion)) arbol.erase({ calificacion, fila });
+    }
+    
+    void cambiar(uint32_t fila, float anterior, float nueva) {
+        quitar(fila, anterior);
+        agregar(fila, nueva);
+    }
+    
+    size_t size() const { return arbol.size(); }
+    bool empty() const { return arbol.empty(); }
+    Arbol::const_iterator begin() const { return arbol.begin(); }
+    Arbol::const_iterator end() const { return arbol.end(); }
+    
+    // Entero que ordena de menor a mayor igual que el índice: calificación de
+    // mayor a menor y, a igualdad, por desempate. Ordenar un arreglo de estas
+    // claves es mucho más rápido que recorrer el árbol saltando por memoria.
+    static uint64_t claveOrden(float calificacion, uint32_t desempate) {
+        uint32_t bits;
+        std::memcpy(&bits, &calificacion, sizeof(bits));
+        bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        return (static_cast<uint64_t>(~bits) << 32) | desempate;
+    }
+    
+    // Posición (desde 0) de la fila en el orden de mayor a menor
+    size_t posicion(uint32_t fila, float calificacion) const {
+        return arbol.order_of_key({ calificacion, fila });
+    }
+    
+    // Fila en la posición dada (desde 0)
+    uint32_t filaEn(size_t posicion) const { return arbol.find_by_order(posicion)->second; }
+    
+    // Cuántas filas tienen calificación >= valor
+    size_t contarDesde(float valor) const { return arbol.order_of_key(cota(valor)); }
+    
+    // Cuántas filas tienen calificación en [minimo, maximo)
+    size_t contarRango(float minimo, float maximo) const {
+        return minimo < maximo ? contarDesde(minimo) - contarDesde(maximo) : 0;
+    }
+    
+    // Recorre las filas con calificación en [minimo, maximo), de mayor a menor
+    template <typename Funcion>
+    void recorrerRango(float minimo, float maximo, Funcion funcion) const {
+        for (auto it = arbol.lower_bound(cota(maximo)); it != arbol.end() && it->first >= minimo; ++it) {
+            funcion(it->second);
+        }
+    }
+    
+    // Las k filas mejor calificadas
+    std::vector<uint32_t> mejores(size_t k) const {
+        std::vector<uint32_t> filas;
+        filas.reserve(std::min(k, arbol.size()));
+        for (auto it = arbol.begin(); it != arbol.end() && filas.size() < k; ++it) {
+            filas.push_back(it->second);
+        }
+        return filas;
     }
 };
 
-// Clase para manejar el historial de calificaciones
-class HistorialManager {
+// Almacén columnar del catálogo. Cada video ocupa una fila (su id) y cada
+// campo vive en su propio arreglo contiguo, de modo que los recorridos solo
+// tocan las columnas que necesitan. Pelicula y Serie son vistas ligeras que
+// guardan únicamente el id de su fila. Las filas de videos destruidos se
+// reutilizan.
+class AlmacenCatalogo {
+public:
+    enum TipoVideo : uint8_t { PELICULA = 0, SERIE = 1 };
+    
+    // Filtro de las consultas de los K mejores; NINGUNO y -1 admiten cualquiera
+    struct FiltroMejores {
+        uint32_t genero = TablaCadenas::NINGUNO;
+        int tipo = -1;
+        
+        bool vacio() const { return genero == TablaCadenas::NINGUNO && tipo < 0; }
+        bool admite(const AlmacenCatalogo& almacen, uint32_t id) const {
+            return (genero == TablaCadenas::NINGUNO || almacen.generos[id] == genero) &&
+                   (tipo < 0 || almacen.tipos[id] == tipo);
+        }
+    };
+
 private:
-    std::string rutaHistorial;
+    std::vector<std::string> titulos;
+    std::vector<float> calificaciones;
+    std::vector<uint16_t> anios;
+    std::vector<uint8_t> tipos;
+    std::vector<uint32_t> generos;
+    std::vector<uint32_t> directores;
+    std::vector<int32_t> duraciones;
+    std::vector<int32_t> episodiosPorTemporada;
+    std::vector<int32_t> numTemporadas;
+    std::vector<int32_t> totalEpisodios;
+    std::vector<uint32_t> filasLibres;
+    EstadisticasCatalogo estadisticas;
+    IndiceCalificaciones porCalificacion;
+    std::unordered_map<uint32_t, EpisodiosSerie> detalleEpisodios;  // sólo series con EPISODIO
+    std::vector<uint64_t> marcas;   // valor de modificaciones tras la última escritura de la fila
+    uint64_t generacion = 0;
+    uint64_t modificaciones = 0;
     
-    std::string obtenerFechaHora() {
-        time_t now = time(0);
-        char* dt = ctime(&now);
-        std::string fecha(dt);
-        fecha.pop_back(); // Remover el \n del final
-        return fecha;
+    void marcar(uint32_t id) { marcas[id] = ++modificaciones; }
+    
+    // Selección parcial sobre las columnas: cada parte conserva sus k mejores
+    // en un montículo cuya cima es la peor, y al final se ordenan las uniones
+    std::vector<uint32_t> mejoresPorRecorrido(size_t k, const FiltroMejores& filtro) const;
+
+public:
+    uint32_t agregarFila(TipoVideo tipo, const std::string& titulo, double calificacion,
+                         const std::string& genero, const std::string& director, int anio) {
+        uint32_t id;
+        if (!filasLibres.empty()) {
+            id = filasLibres.back();
+            filasLibres.pop_back();
+            generacion++;
+        } else {
+            id = static_cast<uint32_t>(titulos.size());
+            titulos.emplace_back();
+            calificaciones.push_back(0);
+            anios.push_back(0);
+            tipos.push_back(0);
+            generos.push_back(0);
+            directores.push_back(0);
+            duraciones.push_back(0);
+            episodiosPorTemporada.push_back(0);
+            numTemporadas.push_back(0);
+            totalEpisodios.push_back(0);
+            marcas.push_back(0);
+        }
+        titulos[id] = titulo;
+        calificaciones[id] = static_cast<float>(calificacion);
+        anios[id] = static_cast<uint16_t>(anio);
+        tipos[id] = tipo;
+        generos[id] = internar(genero);
+        directores[id] = internar(director);
+        duraciones[id] = 0;
+        episodiosPorTemporada[id] = 0;
+        numTemporadas[id] = 0;
+        totalEpisodios[id] = 0;
+        estadisticas.agregar(tipos[id], calificaciones[id], generos[id], directores[id]);
+        porCalificacion.agregar(id, calificaciones[id]);
+        marcar(id);
+        return id;
+    }
+    
+    // Las filas libres quedan con calificación NaN para que los núcleos de
+    // filtrado y agregación las ignoren
+    void liberarFila(uint32_t id) {
+        estadisticas.quitar(tipos[id], calificaciones[id], generos[id], directores[id]);
+        porCalificacion.quitar(id, calificaciones[id]);
+        detalleEpisodios.erase(id);
+        std::string().swap(titulos[id]);
+        calificaciones[id] = std::numeric_limits<float>::quiet_NaN();
+        filasLibres.push_back(id);
+        generacion++;
+        marcar(id);
+    }
+    
+    // Lectura por fila
+    const std::string& titulo(uint32_t id) const { return titulos[id]; }
+    float calificacion(uint32_t id) const { return calificaciones[id]; }
+    int anio(uint32_t id) const { return anios[id]; }
+    TipoVideo tipo(uint32_t id) const { return static_cast<TipoVideo>(tipos[id]); }
+    uint32_t genero(uint32_t id) const { return generos[id]; }
+    uint32_t director(uint32_t id) const { return directores[id]; }
+    int duracion(uint32_t id) const { return duraciones[id]; }
+    int episodiosTemporada(uint32_t id) const { return episodiosPorTemporada[id]; }
+    int temporadas(uint32_t id) const { return numTemporadas[id]; }
+    int episodios(uint32_t id) const { return totalEpisodios[id]; }
+    
+    // Columnas completas para recorridos
+    const std::vector<float>& getCalificaciones() const { return calificaciones; }
+    const std::vector<uint8_t>& getTipos() const { return tipos; }
+    const std::vector<uint32_t>& getGeneros() const { return generos; }
+    const std::vector<uint32_t>& getDirectores() const { return directores; }
+    const EstadisticasCatalogo& getEstadisticas() const { return estadisticas; }
+    const IndiceCalificaciones& getIndiceCalificaciones() const { return porCalificacion; }
+    
+    // Puesto (desde 1) de la fila entre todas, de mayor a menor calificación
+    size_t puestoPorCalificacion(uint32_t id) const {
+        return porCalificacion.posicion(id, calificaciones[id]) + 1;
+    }
+    
+    // Cambia cuando se liberan o reutilizan filas; agregar filas al final no
+    // la cambia, así que los índices pueden seguir indexando sólo las nuevas
+    uint64_t getGeneracion() const { return generacion; }
+    
+    // Cambia con cualquier escritura en el almacén
+    uint64_t getModificaciones() const { return modificaciones; }
+    
+    // Filas escritas (agregadas, liberadas o cambiadas) después de que
+    // getModificaciones() valiera 'desde', en orden
+    std::vector<uint32_t> filasModificadasDesde(uint64_t desde) const {
+        if (desde == modificaciones) return {};
+        return filtrarEnParalelo(marcas.size(), [&](size_t i) { return marcas[i] > desde; });
+    }
+    
+    // Escritura
+    void setCalificacion(uint32_t id, double valor) {
+        float nueva = static_cast<float>(valor);
+        estadisticas.cambiarCalificacion(calificaciones[id], nueva);
+        porCalificacion.cambiar(id, calificaciones[id], nueva);
+        calificaciones[id] = nueva;
+        marcar(id);
+    }
+    
+    void setGenero(uint32_t id, const std::string& genero) {
+        uint32_t nuevo = internar(genero);
+        estadisticas.cambiarGenero(generos[id], nuevo);
+        generos[id] = nuevo;
+        marcar(id);
+    }
+    
+    void setDatosPelicula(uint32_t id, int duracion) {
+        duraciones[id] = duracion;
+        marcar(id);
+    }
+    
+    void setDatosSerie(uint32_t id, int ept, int nt, int te) {
+        episodiosPorTemporada[id] = ept;
+        numTemporadas[id] = nt;
+        totalEpisodios[id] = te;
+        marcar(id);
+    }
+    
+    // Episodios detallados de la serie, o nullptr si no se cargó ninguno
+    const EpisodiosSerie* getDetalleEpisodios(uint32_t id) const {
+        auto it = detalleEpisodios.find(id);
+        return it != detalleEpisodios.end() ? &it->second : nullptr;
+    }
+    
+    EpisodiosSerie& detalleEpisodiosDe(uint32_t id) { return detalleEpisodios[id]; }
+    
+    // Las k filas mejor calificadas que pasan el filtro, de mayor a menor y
+    // en el mismo orden que el índice de calificaciones. Si el filtro deja
+    // pasar suficientes filas se recorre el índice desde el mejor, que se
+    // detiene enseguida; si es muy selectivo (un género raro) se recorren
+    // las columnas en paralelo con un montículo de k por parte: O(n log k).
+    std::vector<uint32_t> mejores(size_t k, const FiltroMejores& filtro) const {
+        if (k == 0) return {};
+        if (filtro.vacio()) return porCalificacion.mejores(k);
+        
+        // Cota de las filas que pasan, según las estadísticas
+        size_t candidatas = estadisticas.getTotal();
+        if (filtro.genero != TablaCadenas::NINGUNO) {
+            candidatas = std::min(candidatas,
+                                  static_cast<size_t>(estadisticas.getGeneros().getCuenta(filtro.genero)));
+        }
+        if (filtro.tipo >= 0) {
+            candidatas = std::min(candidatas, estadisticas.getTotal(static_cast<uint8_t>(filtro.tipo)));
+        }
+        if (candidatas == 0) return {};
+        
+        // Pasos esperados al recorrer el índice: k * total / candidatas
+        const size_t total = porCalificacion.size();
+        double esperados = static_cast<double>(std::min(k, candidatas)) * total / candidatas;
+        if (esperados * 32 <= total) {
+            std::vector<uint32_t> filas;
+            for (auto it = porCalificacion.begin(); it != porCalificacion.end() && filas.size() < k; ++it) {
+                if (filtro.admite(*this, it->second)) filas.push_back(it->second);
+            }
+            return filas;
+        }
+        return mejoresPorRecorrido(k, filtro);
+    }
+    
+    // Nombre del tipo para mostrar; las comparaciones usan el TipoVideo
+    static const std::string& nombreTipo(TipoVideo tipo) {
+        static const uint32_t ids[] = { internar("Pelicula"), internar("Serie") };
+        return textoInternado(ids[tipo]);
+    }
+    
+    static AlmacenCatalogo& global() {
+        static AlmacenCatalogo almacen;
+        return almacen;
+    }
+};
+
+inline std::vector<uint32_t> AlmacenCatalogo::mejoresPorRecorrido(size_t k, const FiltroMejores& filtro) const {
+    using Clave = IndiceCalificaciones::Clave;
+    const IndiceCalificaciones::MayorPrimero mejor;
+    const size_t n = calificaciones.size();
+    
+    PoolHilos& pool = PoolHilos::compartido();
+    std::vector<std::vector<Clave>> parciales(pool.partesPara(n));
+    pool.paraRangos(n, [&](size_t p, size_t desde, size_t hasta) {
+        std::vector<Clave>& monticulo = parciales[p];
+        for (size_t i = desde; i < hasta; i++) {
+            uint32_t id = static_cast<uint32_t>(i);
+            float calificacion = calificaciones[id];
+            if (std::isnan(calificacion) || !filtro.admite(*this, id)) continue;
+            Clave clave{ calificacion, id };
+            if (monticulo.size() < k) {
+                monticulo.push_back(clave);
+                std::push_heap(monticulo.begin(), monticulo.end(), mejor);
+            } else if (mejor(clave, monticulo.front())) {
+                std::pop_heap(monticulo.begin(), monticulo.end(), mejor);
+                monticulo.back() = clave;
+                std::push_heap(monticulo.begin(), monticulo.end(), mejor);
+            }
+        }
+    });
+    
+    std::vector<Clave> unidas;
+    for (auto& parcial : parciales) unidas.insert(unidas.end(), parcial.begin(), parcial.end());
+    size_t cuantas = std::min(k, unidas.size());
+    std::partial_sort(unidas.begin(), unidas.begin() + cuantas, unidas.end(), mejor);
+    
+    std::vector<uint32_t> filas(cuantas);
+    for (size_t i = 0; i < cuantas; i++) filas[i] = unidas[i].second;
+    return filas;
+}
+
+// Rasgos de un título con los que se mide su parecido a otros
+struct RasgosVideo {
+    uint32_t genero;
+    uint32_t director;
+    float calificacion;
+    float largo;        // log(1 + minutos) en películas, log(1 + episodios) en series
+    uint16_t anio;      // 0 si no se conoce (las series no lo traen)
+    uint8_t tipo;
+    
+    static RasgosVideo de(const AlmacenCatalogo& almacen, uint32_t id) {
+        RasgosVideo r;
+        r.genero = almacen.genero(id);
+        r.director = almacen.director(id);
+        r.calificacion = almacen.calificacion(id);
+        r.tipo = almacen.tipo(id);
+        int largo = r.tipo == AlmacenCatalogo::PELICULA ? almacen.duracion(id) : almacen.episodios(id);
+        r.largo = std::log1p(static_cast<float>(std::max(0, largo)));
+        r.anio = static_cast<uint16_t>(std::max(0, almacen.anio(id)));
+        return r;
+    }
+};
+
+// Distancia entre títulos: suma ponderada de diferencias acotadas. Pesa más
+// compartir género, luego director; tipo, año, calificación y largo afinan.
+// Cada término es una métrica (igualdad, o diferencia absoluta recortada;
+// un año desconocido queda a media distancia de cualquiera), así que la
+// suma también lo es y el árbol de puntos de vista puede podar con ella.
+inline float distanciaRasgos(const RasgosVideo& a, const RasgosVideo& b) {
+    float d = 0;
+    if (a.genero != b.genero) d += 3.0f;
+    if (a.director != b.director) d += 2.0f;
+    if (a.tipo != b.tipo) d += 1.0f;
+    if (a.anio == 0 || b.anio == 0) {
+        if (a.anio != b.anio) d += 0.5f;
+    } else {
+        d += std::min(std::abs(static_cast<int>(a.anio) - static_cast<int>(b.anio)) / 30.0f, 1.0f);
+    }
+    d += 1.5f * std::min(std::abs(a.calificacion - b.calificacion) / 10.0f, 1.0f);
+    d += 0.5f * std::min(std::abs(a.largo - b.largo) / 1.4f, 1.0f);
+    return d;
+}
+
+// Los k más parecidos vistos hasta ahora, como montículo con el peor arriba
+class MasParecidos {
+private:
+    size_t k;
+    std::vector<std::pair<float, uint32_t>> monticulo;   // (distancia, fila)
+
+public:
+    explicit MasParecidos(size_t cuantos) : k(cuantos) { monticulo.reserve(cuantos + 1); }
+    
+    // Distancia que hay que mejorar para entrar (infinita mientras falten)
+    float umbral() const {
+        return monticulo.size() < k ? std::numeric_limits<float>::infinity() : monticulo.front().first;
+    }
+    
+    void considerar(float distancia, uint32_t fila) {
+        std::pair<float, uint32_t> candidato(distancia, fila);
+        if (monticulo.size() < k) {
+            monticulo.push_back(candidato);
+            std::push_heap(monticulo.begin(), monticulo.end());
+        } else if (k > 0 && candidato < monticulo.front()) {
+            std::pop_heap(monticulo.begin(), monticulo.end());
+            monticulo.back() = candidato;
+            std::push_heap(monticulo.begin(), monticulo.end());
+        }
+    }
+    
+    void unir(const MasParecidos& otro) {
+        for (const auto& par : otro.monticulo) considerar(par.first, par.second);
+    }
+    
+    // Del más parecido al menos
+    std::vector<std::pair<float, uint32_t>> ordenados() const {
+        std::vector<std::pair<float, uint32_t>> lista(monticulo);
+        std::sort(lista.begin(), lista.end());
+        return lista;
+    }
+};
+
+// Árbol de puntos de vista (VP-tree) sobre los rasgos. Cada nodo elige un
+// título y reparte el resto en los que quedan a menos de la mediana de la
+// distancia a él y los demás; al buscar, una rama se salta si la
+// desigualdad triangular asegura que no puede mejorar a los k actuales.
+// Se guarda en un solo arreglo: el nodo del tramo [desde, hasta) está en
+// desde, su mitad cercana en [desde + 1, medio) y la lejana en [medio, hasta).
+class ArbolPuntosVista {
+public:
+    struct Punto {
+        RasgosVideo rasgos;
+        uint32_t fila;
+        float radio;        // en un nodo, la mediana; mientras se construye, la distancia
+    };
+
+private:
+    static constexpr size_t HOJA = 16;
+    std::vector<Punto> puntos;
+    
+    static size_t medio(size_t desde, size_t hasta) { return desde + 1 + (hasta - desde - 1) / 2; }
+    
+    void construir(size_t desde, size_t hasta, std::minstd_rand& azar) {
+        while (hasta - desde > HOJA) {
+            std::swap(puntos[desde], puntos[desde + azar() % (hasta - desde)]);
+            const RasgosVideo vista = puntos[desde].rasgos;
+            for (size_t i = desde + 1; i < hasta; i++) puntos[i].radio = distanciaRasgos(vista, puntos[i].rasgos);
+            size_t m = medio(desde, hasta);
+            std::nth_element(puntos.begin() + desde + 1, puntos.begin() + m, puntos.begin() + hasta,
+                             [](const Punto& a, const Punto& b) { return a.radio < b.radio; });
+            puntos[desde].radio = puntos[m].radio;
+            construir(desde + 1, m, azar);
+            desde = m;
+        }
+    }
+    
+    // Los puntos descartados no entran en mejores pero siguen guiando la
+    // poda: las cotas valen para los rasgos con que se armó el árbol
+    template <typename Descartar>
+    void buscar(size_t desde, size_t hasta, const RasgosVideo& consulta, const Descartar& descartar,
+                MasParecidos& mejores) const {
+        if (hasta - desde <= HOJA) {
+            for (size_t i = desde; i < hasta; i++) {
+                if (!descartar(puntos[i].fila)) mejores.considerar(distanciaRasgos(consulta, puntos[i].rasgos), puntos[i].fila);
+            }
+            return;
+        }
+        const Punto& nodo = puntos[desde];
+        float d = distanciaRasgos(consulta, nodo.rasgos);
+        if (!descartar(nodo.fila)) mejores.considerar(d, nodo.fila);
+        
+        // Margen por redondeo de float en la desigualdad triangular
+        const float margen = 1e-4f;
+        size_t m = medio(desde, hasta);
+        if (d < nodo.radio) {
+            buscar(desde + 1, m, consulta, descartar, mejores);
+            if (d + mejores.umbral() + margen >= nodo.radio) buscar(m, hasta, consulta, descartar, mejores);
+        } else {
+            buscar(m, hasta, consulta, descartar, mejores);
+            if (d - mejores.umbral() - margen <= nodo.radio) buscar(desde + 1, m, consulta, descartar, mejores);
+        }
+    }
+
+public:
+    explicit ArbolPuntosVista(std::vector<Punto> p) : puntos(std::move(p)) {
+        std::minstd_rand azar(12345);
+        construir(0, puntos.size(), azar);
+    }
+    
+    size_t size() const { return puntos.size(); }
+    
+    template <typename Descartar>
+    void buscar(const RasgosVideo& consulta, const Descartar& descartar, MasParecidos& mejores) const {
+        buscar(0, puntos.size(), consulta, descartar, mejores);
+    }
+};
+
+// Títulos parecidos a uno dado. El árbol se construye en segundo plano con
+// una copia de los rasgos. Mientras el almacén no libere ni reutilice filas
+// se sigue usando: las filas escritas después de armarlo (calificaciones o
+// géneros cambiados, títulos agregados) se descartan al recorrerlo y se
+// comparan aparte con sus rasgos actuales. Sólo se pide otro árbol cuando
+// esas filas pasan de una fracción del árbol o cambió la generación; sin
+// árbol vigente se recorre todo en paralelo.
+class MotorSimilitud {
+private:
+    struct Indice {
+        ArbolPuntosVista arbol;
+        uint64_t generacion;
+        uint64_t modificaciones;
+    };
+    
+    // Más filas escritas que arbol.size() / FRACCION_EDITADAS piden otro árbol
+    static constexpr size_t FRACCION_EDITADAS = 256;
+    
+    std::mutex mutex;
+    std::shared_ptr<const Indice> indice;
+    bool construyendo = false;
+    
+    // Filas escritas desde que se armó 'editadasDe', calculadas cuando el
+    // almacén valía 'editadasHasta' modificaciones, en lista y como mapa de
+    // bits por fila. Sólo las usa el hilo que escribe en el almacén, como
+    // preparar y buscar.
+    std::weak_ptr<const Indice> editadasDe;
+    uint64_t editadasHasta = 0;
+    std::vector<uint32_t> editadas;
+    std::vector<bool> esEditada;
+    
+    PoolHilos constructor;  // último miembro: se destruye primero
+    
+    const std::vector<uint32_t>& filasEditadas(const AlmacenCatalogo& almacen,
+                                               const std::shared_ptr<const Indice>& actual) {
+        if (editadasDe.lock() != actual || editadasHasta != almacen.getModificaciones()) {
+            editadas = almacen.filasModificadasDesde(actual->modificaciones);
+            esEditada.assign(almacen.getCalificaciones().size(), false);
+            for (uint32_t fila : editadas) esEditada[fila] = true;
+            editadasDe = actual;
+            editadasHasta = almacen.getModificaciones();
+        }
+        return editadas;
+    }
+    
+    static void recorrer(const AlmacenCatalogo& almacen, size_t desde, size_t hasta,
+                         const RasgosVideo& consulta, uint32_t excluir, MasParecidos& mejores) {
+        const auto& calificaciones = almacen.getCalificaciones();
+        for (size_t i = desde; i < hasta; i++) {
+            uint32_t fila = static_cast<uint32_t>(i);
+            if (fila == excluir || std::isnan(calificaciones[i])) continue;
+            mejores.considerar(distanciaRasgos(consulta, RasgosVideo::de(almacen, fila)), fila);
+        }
+    }
+    
+    static void recorrerEnParalelo(const AlmacenCatalogo& almacen, size_t k,
+                                   const RasgosVideo& consulta, uint32_t excluir, MasParecidos& mejores) {
+        size_t n = almacen.getCalificaciones().size();
+        PoolHilos& pool = PoolHilos::compartido();
+        std::vector<MasParecidos> parciales(pool.partesPara(n), MasParecidos(k));
+        pool.paraRangos(n, [&](size_t parte, size_t inicio, size_t fin) {
+            recorrer(almacen, inicio, fin, consulta, excluir, parciales[parte]);
+        });
+        for (const auto& parcial : parciales) mejores.unir(parcial);
+    }
+
+public:
+    MotorSimilitud() : constructor(1) {}
+    
+    // Pide un árbol nuevo si no hay, si cambió la generación o si ya hay
+    // demasiadas filas escritas desde el actual. Los rasgos se copian aquí
+    // (en el hilo que llama, que es el único que escribe en el almacén); el
+    // árbol se arma en el hilo constructor.
+    void preparar() {
+        const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+        std::shared_ptr<const Indice> actual;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (construyendo) return;
+            actual = indice;
+        }
+        if (actual && actual->generacion == almacen.getGeneracion() &&
+            filasEditadas(almacen, actual).size() <= actual->arbol.size() / FRACCION_EDITADAS) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (construyendo) return;
+            construyendo = true;
+        }
+        
+        const auto& calificaciones = almacen.getCalificaciones();
+        std::vector<ArbolPuntosVista::Punto> puntos;
+        puntos.reserve(almacen.getIndiceCalificaciones().size());
+        for (size_t i = 0; i < calificaciones.size(); i++) {
+            if (std::isnan(calificaciones[i])) continue;
+            uint32_t fila = static_cast<uint32_t>(i);
+            puntos.push_back({ RasgosVideo::de(almacen, fila), fila, 0 });
+        }
+        uint64_t generacion = almacen.getGeneracion();
+        uint64_t modificaciones = almacen.getModificaciones();
+        
+        constructor.encolar([this, puntos = std::move(puntos), generacion, modificaciones]() mutable {
+            std::shared_ptr<const Indice> nuevo;
+            try {
+                nuevo = std::make_shared<const Indice>(
+                    Indice{ ArbolPuntosVista(std::move(puntos)), generacion, modificaciones });
+            } catch (const std::exception&) {
+                // Sin memoria para el árbol: se sigue recorriendo todo
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (nuevo) indice = std::move(nuevo);
+            construyendo = false;
+        });
+    }
+    
+    // Los k títulos más parecidos a la fila, del más parecido al menos, como
+    // pares (distancia, fila). usoArbol dice si se pudo usar el árbol.
+    std::vector<std::pair<float, uint32_t>> buscar(uint32_t fila, size_t k, bool& usoArbol) {
+        const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+        RasgosVideo consulta = RasgosVideo::de(almacen, fila);
+        std::shared_ptr<const Indice> actual;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            actual = indice;
+        }
+        
+        // Si se liberaron o reutilizaron filas, el árbol puede tener títulos
+        // que ya no existen o son otros
+        MasParecidos mejores(k);
+        usoArbol = actual && actual->generacion == almacen.getGeneracion();
+        if (usoArbol) {
+            const std::vector<uint32_t>& escritas = filasEditadas(almacen, actual);
+            actual->arbol.buscar(consulta, [&](uint32_t f) { return f == fila || esEditada[f]; }, mejores);
+            for (uint32_t f : escritas) {
+                if (f == fila || std::isnan(almacen.calificacion(f))) continue;
+                mejores.considerar(distanciaRasgos(consulta, RasgosVideo::de(almacen, f)), f);
+            }
+        } else {
+            recorrerEnParalelo(almacen, k, consulta, fila, mejores);
+        }
+        
+        preparar();
+        return mejores.ordenados();
+    }
+};
+
+// Índice de búsqueda por texto sobre las filas de AlmacenCatalogo. Todo se
+// compara en la forma de normalizarBusqueda, así que no importan mayúsculas,
+// acentos ni signos. Los títulos se indexan por trigramas (con dos espacios
+// de relleno a cada lado) para subcadenas de 3 o más letras y búsquedas
+// aproximadas, y en un arreglo ordenado para prefijos de 1 o 2; géneros y
+// directores se comparan contra la tabla de nombres internados, que es
+// pequeña. Las filas nuevas se indexan al vuelo; sólo se reconstruye todo
+// cuando el almacén libera o reutiliza filas.
+class IndiceBusqueda {
+private:
+    std::vector<std::string> titulosNormalizados;   // por fila; vacío si está libre
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigramas;
+    std::unordered_multimap<size_t, uint32_t> porTitulo;   // hash del título normalizado -> fila
+    std::vector<uint32_t> prefijos;                 // filas ordenadas por título
+    bool prefijosOrdenados = true;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> filasPorDirector;
+    std::vector<std::string> nombresNormalizados;   // por id internado
+    uint64_t generacion = UINT64_MAX;
+    
+    static uint32_t trigrama(const char* p) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 16) |
+               (static_cast<uint32_t>(static_cast<unsigned char>(p[1])) << 8) |
+               static_cast<unsigned char>(p[2]);
+    }
+    
+    static std::string conRelleno(const std::string& texto) {
+        return "  " + texto + "  ";
+    }
+    
+    void indexarFila(const AlmacenCatalogo& almacen, uint32_t fila) {
+        titulosNormalizados.emplace_back();
+        if (std::isnan(almacen.calificacion(fila))) return;     // fila libre
+        
+        titulosNormalizados[fila] = normalizarBusqueda(almacen.titulo(fila));
+        filasPorDirector[almacen.director(fila)].push_back(fila);
+        if (titulosNormalizados[fila].empty()) return;
+        porTitulo.emplace(std::hash<std::string>{}(titulosNormalizados[fila]), fila);
+        
+        // Las filas llegan en orden creciente, así que las listas quedan ordenadas
+        std::string relleno = conRelleno(titulosNormalizados[fila]);
+        for (size_t i = 0; i + 3 <= relleno.size(); i++) {
+            auto& lista = trigramas[trigrama(relleno.data() + i)];
+            if (lista.empty() || lista.back() != fila) lista.push_back(fila);
+        }
+        prefijos.push_back(fila);
+        prefijosOrdenados = false;
+    }
+    
+    // Pone el índice al día con el almacén
+    void sincronizar(const AlmacenCatalogo& almacen) {
+        if (almacen.getGeneracion() != generacion) {
+            titulosNormalizados.clear();
+            trigramas.clear();
+            porTitulo.clear();
+            prefijos.clear();
+            filasPorDirector.clear();
+            generacion = almacen.getGeneracion();
+        }
+        uint32_t filas = static_cast<uint32_t>(almacen.getCalificaciones().size());
+        for (uint32_t fila = static_cast<uint32_t>(titulosNormalizados.size()); fila < filas; fila++) {
+            indexarFila(almacen, fila);
+        }
+    }
+    
+    void ordenarPrefijos() {
+        if (prefijosOrdenados) return;
+        std::sort(prefijos.begin(), prefijos.end(), [this](uint32_t a, uint32_t b) {
+            return titulosNormalizados[a] < titulosNormalizados[b];
+        });
+        prefijosOrdenados = true;
+    }
+    
+    const std::vector<uint32_t>* listaTrigrama(const char* p) const {
+        auto it = trigramas.find(trigrama(p));
+        return it != trigramas.end() ? &it->second : nullptr;
+    }
+    
+    void buscarEnTitulos(const std::string& consulta, std::vector<uint64_t>& coincidencias) {
+        auto marcar = [&](uint32_t fila) { coincidencias[fila / 64] |= 1ull << (fila % 64); };
+        
+        if (consulta.size() < 3) {
+            ordenarPrefijos();
+            auto it = std::lower_bound(prefijos.begin(), prefijos.end(), consulta,
+                [this](uint32_t fila, const std::string& valor) {
+                    return titulosNormalizados[fila] < valor;
+                });
+            for (; it != prefijos.end() && titulosNormalizados[*it].compare(0, consulta.size(), consulta) == 0; ++it) {
+                marcar(*it);
+            }
+            return;
+        }
+        
+        // Se cruzan las dos listas de trigramas más cortas; las demás no
+        // filtran mucho más y la subcadena se confirma igual al final
+        const std::vector<uint32_t>* corta = nullptr;
+        const std::vector<uint32_t>* segunda = nullptr;
+        for (size_t i = 0; i + 3 <= consulta.size(); i++) {
+            const std::vector<uint32_t>* lista = listaTrigrama(consulta.data() + i);
+            if (!lista) return;
+            if (!corta || lista->size() < corta->size()) {
+                segunda = corta;
+                corta = lista;
+            } else if (lista != corta && (!segunda || lista->size() < segunda->size())) {
+                segunda = lista;
+            }
+        }
+        
+        std::vector<uint32_t> candidatos;
+        if (!segunda) {
+            candidatos = *corta;
+        } else if (segunda->size() / 16 > corta->size()) {
+            for (uint32_t fila : *corta) {
+                if (std::binary_search(segunda->begin(), segunda->end(), fila)) candidatos.push_back(fila);
+            }
+        } else {
+            std::set_intersection(corta->begin(), corta->end(), segunda->begin(), segunda->end(),
+                                  std::back_inserter(candidatos));
+        }
+        
+        for (uint32_t fila : candidatos) {
+            if (titulosNormalizados[fila].find(consulta) != std::string::npos) marcar(fila);
+        }
+    }
+    
+    void buscarEnNombres(const AlmacenCatalogo& almacen, const std::string& consulta,
+                         std::vector<uint64_t>& coincidencias) {
+        const TablaCadenas& tabla = TablaCadenas::global();
+        while (nombresNormalizados.size() < tabla.size()) {
+            nombresNormalizados.push_back(normalizarBusqueda(tabla.texto(static_cast<uint32_t>(nombresNormalizados.size()))));
+        }
+        
+        const EstadisticasCatalogo& estadisticas = almacen.getEstadisticas();
+        std::vector<bool> generoCoincide(nombresNormalizados.size(), false);
+        bool algunGenero = false;
+        for (uint32_t id = 0; id < nombresNormalizados.size(); id++) {
+            if (nombresNormalizados[id].find(consulta) == std::string::npos) continue;
+            auto it = filasPorDirector.find(id);
+            if (it != filasPorDirector.end()) {
+                for (uint32_t fila : it->second) coincidencias[fila / 64] |= 1ull << (fila % 64);
+            }
+            if (estadisticas.getGeneros().getCuenta(id) > 0) {
+                generoCoincide[id] = true;
+                algunGenero = true;
+            }
+        }
+        if (!algunGenero) return;
+        
+        const auto& generos = almacen.getGeneros();
+        for (uint32_t fila = 0; fila < generos.size(); fila++) {
+            if (generoCoincide[generos[fila]]) coincidencias[fila / 64] |= 1ull << (fila % 64);
+        }
+    }
+
+public:
+    // Errores que se toleran según el largo de lo buscado
+    static int tolerancia(size_t longitud) {
+        return longitud <= 4 ? 1 : longitud <= 10 ? 2 : 3;
+    }
+    
+    // Distancia de Levenshtein si no pasa de maximo; si pasa, maximo + 1.
+    // Sólo se calcula la franja |i - j| <= maximo de la tabla.
+    static int distanciaAcotada(std::string_view a, std::string_view b, int maximo) {
+        int n = static_cast<int>(a.size());
+        int m = static_cast<int>(b.size());
+        if (std::abs(n - m) > maximo) return maximo + 1;
+        
+        const int fuera = maximo + 1;
+        std::vector<int> previa(m + 1, fuera), actual(m + 1, fuera);
+        for (int j = 0; j <= std::min(m, maximo); j++) previa[j] = j;
+        for (int i = 1; i <= n; i++) {
+            int desde = std::max(1, i - maximo);
+            int hasta = std::min(m, i + maximo);
+            std::fill(actual.begin(), actual.end(), fuera);
+            if (i <= maximo) actual[0] = i;
+            int minimoFila = actual[0];
+            for (int j = desde; j <= hasta; j++) {
+                actual[j] = std::min({ previa[j] + 1, actual[j - 1] + 1,
+                                       previa[j - 1] + (a[i - 1] != b[j - 1] ? 1 : 0) });
+                minimoFila = std::min(minimoFila, actual[j]);
+            }
+            if (minimoFila > maximo) return fuera;
+            previa.swap(actual);
+        }
+        return std::min(previa[m], fuera);
+    }
+    
+    // Filas cuyo título, género o director contienen la consulta y con
+    // calificación >= minima. Devuelve cuántas.
+    size_t buscar(std::string_view consulta, double minima, std::vector<uint64_t>& bitmap) {
+        const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+        sincronizar(almacen);
+        
+        const auto& calificaciones = almacen.getCalificaciones();
+        float minimo = static_cast<float>(minima);
+        std::string clave = normalizarBusqueda(consulta);
+        if (clave.empty()) {
+            return filtrarCalificaciones(calificaciones, minimo,
+                                         std::numeric_limits<float>::infinity(), bitmap).cuenta;
+        }
+        
+        bitmap.assign((calificaciones.size() + 63) / 64, 0);
+        buscarEnTitulos(clave, bitmap);
+        buscarEnNombres(almacen, clave, bitmap);
+        
+        // La calificación sólo se mira en las filas que coinciden; las libres
+        // tienen NaN y tampoco pasan
+        size_t total = 0;
+        for (size_t i = 0; i < bitmap.size(); i++) {
+            uint64_t palabra = bitmap[i];
+            for (uint64_t resto = palabra; resto; resto &= resto - 1) {
+                int bit = __builtin_ctzll(resto);
+                if (!(calificaciones[i * 64 + bit] >= minimo)) palabra &= ~(1ull << bit);
+            }
+            bitmap[i] = palabra;
+            total += static_cast<size_t>(__builtin_popcountll(palabra));
+        }
+        return total;
+    }
+    
+    // Títulos a distancia de edición <= tolerancia del título buscado, del
+    // más parecido al menos, como pares (distancia, fila). Un título a k
+    // errores pierde como mucho 3k de sus trigramas, así que basta con
+    // recorrer las 3k+1 listas más cortas para no perder ningún candidato.
+    std::vector<std::pair<int, uint32_t>> buscarAproximado(std::string_view titulo, size_t maxResultados) {
+        const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+        sincronizar(almacen);
+        
+        std::vector<std::pair<int, uint32_t>> resultados;
+        std::string clave = normalizarBusqueda(titulo);
+        if (clave.empty()) return resultados;
+        
+        std::string relleno = conRelleno(clave);
+        std::vector<uint32_t> gramas;
+        for (size_t i = 0; i + 3 <= relleno.size(); i++) gramas.push_back(trigrama(relleno.data() + i));
+        std::sort(gramas.begin(), gramas.end());
+        gramas.erase(std::unique(gramas.begin(), gramas.end()), gramas.end());
+        
+        int maximo = std::min(tolerancia(clave.size()), static_cast<int>(gramas.size() - 1) / 3);
+        std::vector<const std::vector<uint32_t>*> listas;
+        for (uint32_t grama : gramas) {
+            auto it = trigramas.find(grama);
+            listas.push_back(it != trigramas.end() ? &it->second : nullptr);
+        }
+        std::sort(listas.begin(), listas.end(), [](const auto* a, const auto* b) {
+            return (a ? a->size() : 0) < (b ? b->size() : 0);
+        });
+        
+        std::vector<uint32_t> candidatos;
+        for (size_t k = 0; k < listas.size() && k < static_cast<size_t>(3 * maximo + 1); k++) {
+            if (listas[k]) candidatos.insert(candidatos.end(), listas[k]->begin(), listas[k]->end());
+        }
+        std::sort(candidatos.begin(), candidatos.end());
+        candidatos.erase(std::unique(candidatos.begin(), candidatos.end()), candidatos.end());
+        
+        for (uint32_t fila : candidatos) {
+            int distancia = distanciaAcotada(clave, titulosNormalizados[fila], maximo);
+            if (distancia <= maximo) resultados.emplace_back(distancia, fila);
+        }
+        std::sort(resultados.begin(), resultados.end());
+        if (resultados.size() > maxResultados) resultados.resize(maxResultados);
+        return resultados;
+    }
+    
+    // La fila del único título igual al buscado salvo mayúsculas, acentos y
+    // signos; falla si no hay ninguno o si hay más de uno
+    bool resolverPlegado(std::string_view titulo, uint32_t& fila) {
+        sincronizar(AlmacenCatalogo::global());
+        std::string clave = normalizarBusqueda(titulo);
+        if (clave.empty()) return false;
+        
+        size_t encontrados = 0;
+        auto rango = porTitulo.equal_range(std::hash<std::string>{}(clave));
+        for (auto it = rango.first; it != rango.second; ++it) {
+            if (titulosNormalizados[it->second] != clave) continue;
+            fila = it->second;
+            encontrados++;
+        }
+        return encontrados == 1;
+    }
+};
+
+// Conjunto de archivos del directorio de portadas. Se llena con una sola
+// lectura del directorio y un hilo lo mantiene al día (inotify en Linux; en
+// otros sistemas, o si inotify no puede vigilarlo, se relee cuando cambia la
+// fecha del directorio), así que
+// saber si existe una portada no abre ningún archivo. Los nombres que cambian
+// se avisan en el hilo de FLTK mediante Fl::awake.
+class IndicePortadas {
+private:
+    std::string directorio;
+    mutable std::mutex mutex;
+    std::unordered_set<std::string> nombres;
+    std::vector<std::string> cambios;       // pendientes de avisar
+    std::function<void(const std::vector<std::string>&)> alCambiar;
+    std::atomic<bool> detener;
+#ifdef __linux__
+    int tuberia[2];                         // despierta al vigilante al cerrar
+#else
+    std::condition_variable despertar;
+#endif
+    std::thread vigilante;
+    
+    // Como en el sistema de archivos: en Windows los nombres no distinguen
+    // mayúsculas
+    static std::string normalizar(std::string nombre) {
+#ifdef _WIN32
+        std::transform(nombre.begin(), nombre.end(), nombre.begin(), ::tolower);
+#endif
+        return nombre;
+    }
+    
+    std::unordered_set<std::string> leerDirectorio() const {
+        std::unordered_set<std::string> encontrados;
+        std::error_code ec;
+        std::filesystem::directory_iterator it(directorio, ec);
+        for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            if (it->is_regular_file(ec)) {
+                encontrados.insert(normalizar(it->path().filename().string()));
+            }
+        }
+        return encontrados;
+    }
+    
+    void aplicar(const std::string& nombre, bool existe) {
+        std::string clave = normalizar(nombre);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (existe) {
+            nombres.insert(clave);
+        } else {
+            nombres.erase(clave);
+        }
+        cambios.push_back(std::move(clave));
+    }
+    
+    void reemplazar(std::unordered_set<std::string> nuevos) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& nombre : nombres) {
+            if (!nuevos.count(nombre)) cambios.push_back(nombre);
+        }
+        for (const auto& nombre : nuevos) {
+            if (!nombres.count(nombre)) cambios.push_back(nombre);
+        }
+        nombres = std::move(nuevos);
+    }
+    
+    void avisar() {
+        bool hayCambios;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            hayCambios = !cambios.empty();
+        }
+        if (hayCambios) Fl::awake(entregar, this);
+    }
+    
+    // Se ejecuta en el hilo de FLTK
+    static void entregar(void* datos) {
+        IndicePortadas* indice = static_cast<IndicePortadas*>(datos);
+        std::vector<std::string> nombresCambiados;
+        {
+            std::lock_guard<std::mutex> lock(indice->mutex);
+            nombresCambiados.swap(indice->cambios);
+        }
+        if (!nombresCambiados.empty() && indice->alCambiar) indice->alCambiar(nombresCambiados);
+    }
+    
+    // Espera el siguiente sondeo; true si hay que terminar
+#ifdef __linux__
+    bool esperarSondeo() {
+        pollfd espera = { tuberia[0], POLLIN, 0 };
+        int listos = poll(&espera, 1, 2000);
+        return detener || (listos > 0 && espera.revents);
+    }
+#else
+    bool esperarSondeo() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return despertar.wait_for(lock, std::chrono::seconds(2), [this] { return detener.load(); });
+    }
+#endif
+    
+    // Relee el directorio cuando cambia su fecha. Si todavía no existe, la
+    // fecha cambia al crearlo.
+    void sondear() {
+        std::error_code ec;
+        auto fecha = std::filesystem::last_write_time(directorio, ec);
+        reemplazar(leerDirectorio());
+        avisar();
+        while (!esperarSondeo()) {
+            auto nuevaFecha = std::filesystem::last_write_time(directorio, ec);
+            if (!ec && nuevaFecha != fecha) {
+                fecha = nuevaFecha;
+                reemplazar(leerDirectorio());
+                avisar();
+            }
+        }
+    }
+    
+#ifdef __linux__
+    void vigilar() {
+        // Sin inotify (directorio inexistente, ruta con separadores de
+        // Windows, límite de vigilancias agotado) se sondea como en otros sistemas
+        int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        if (fd < 0) {
+            sondear();
+            return;
+        }
+        if (inotify_add_watch(fd, directorio.c_str(),
+                              IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0) {
+            close(fd);
+            sondear();
+            return;
+        }
+        // Lo que haya cambiado entre la primera lectura y la vigilancia
+        reemplazar(leerDirectorio());
+        avisar();
+        
+        alignas(inotify_event) char buffer[16 * 1024];
+        pollfd esperas[2] = { { fd, POLLIN, 0 }, { tuberia[0], POLLIN, 0 } };
+        while (!detener) {
+            if (poll(esperas, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (esperas[1].revents) break;
+            
+            ssize_t leidos = read(fd, buffer, sizeof(buffer));
+            if (leidos <= 0) continue;
+            for (char* p = buffer; p < buffer + leidos; ) {
+                const inotify_event* evento = reinterpret_cast<const inotify_event*>(p);
+                if (evento->mask & IN_Q_OVERFLOW) {
+                    reemplazar(leerDirectorio());
+                } else if (evento->len > 0) {
+                    aplicar(evento->name, (evento->mask & (IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO)) != 0);
+                }
+                p += sizeof(inotify_event) + evento->len;
+            }
+            avisar();
+        }
+        close(fd);
+    }
+#else
+    void vigilar() {
+        sondear();
+    }
+#endif
+
+public:
+    explicit IndicePortadas(const std::string& dir) 
+        : directorio(dir), detener(false) {
+        nombres = leerDirectorio();
+#ifdef __linux__
+        if (pipe(tuberia) != 0) {
+            tuberia[0] = tuberia[1] = -1;
+            return;     // sin forma de despertarlo, no se vigila
+        }
+#endif
+        vigilante = std::thread([this] { vigilar(); });
+    }
+    
+    ~IndicePortadas() {
+        detener = true;
+#ifdef __linux__
+        if (tuberia[1] >= 0) {
+            ssize_t escritos = write(tuberia[1], "x", 1);
+            (void)escritos;
+        }
+#else
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        despertar.notify_all();
+#endif
+        if (vigilante.joinable()) vigilante.join();
+#ifdef __linux__
+        if (tuberia[0] >= 0) {
+            close(tuberia[0]);
+            close(tuberia[1]);
+        }
+#endif
+    }
+    
+    IndicePortadas(const IndicePortadas&) = delete;
+    IndicePortadas& operator=(const IndicePortadas&) = delete;
+    
+    const std::string& getDirectorio() const { return directorio; }
+    
+    bool existe(const std::string& nombreArchivo) const {
+        std::string clave = normalizar(nombreArchivo);
+        std::lock_guard<std::mutex> lock(mutex);
+        return nombres.count(clave) > 0;
+    }
+    
+    // Recibe los nombres que aparecieron, desaparecieron o se reescribieron
+    void setAlCambiar(std::function<void(const std::vector<std::string>&)> funcion) {
+        alCambiar = std::move(funcion);
+    }
+};
+
+// Escritura de números al final de una cadena con std::to_chars: sin flujos
+// ni locale. agregarDecimal da el mismo texto que std::fixed con esa precisión.
+inline void agregarEntero(std::string& destino, long long valor) {
+    char texto[24];
+    auto res = std::to_chars(texto, texto + sizeof(texto), valor);
+    destino.append(texto, res.ptr);
+}
+
+inline void agregarDecimal(std::string& destino, double valor, int decimales) {
+    char texto[64];
+    auto res = std::to_chars(texto, texto + sizeof(texto), valor, std::chars_format::fixed, decimales);
+    if (res.ec == std::errc()) destino.append(texto, res.ptr);
+}
+
+// Clase base Video: vista sobre una fila de AlmacenCatalogo
+class Video {
+protected:
+    uint32_t id;
+    static inline const std::string basePath = ".\\";
+    
+    static AlmacenCatalogo& almacen() { return AlmacenCatalogo::global(); }
+
+public:
+    // Sobrecarga de operadores
+    Video& operator+=(double puntos) {
+        almacen().setCalificacion(id, std::min(10.0, getCalificacion() + puntos));
+        return *this;
+    }
+
+    Video& operator-=(double puntos) {
+        almacen().setCalificacion(id, std::max(0.0, getCalificacion() - puntos));
+        return *this;
+    }
+
+    Video(AlmacenCatalogo::TipoVideo tipo, const std::string& t, double cal, 
+          const std::string& g, const std::string& dir, int a)
+        : id(almacen().agregarFila(tipo, t, cal, g, dir, a)) {}
+        
+    virtual ~Video() {
+        almacen().liberarFila(id);
+    }
+    
+    Video(const Video&) = delete;
+    Video& operator=(const Video&) = delete;
+        
+    // Función friend para operator<<
+    friend std::ostream& operator<<(std::ostream& os, const Video& video) {
+        os << video.getInfo();
+        return os;
+    }
+    
+    // Agrega la línea de información al final de destino; los listados
+    // reutilizan la misma cadena para no reservar memoria por fila
+    virtual void escribirInfo(std::string& destino) const = 0;
+    virtual std::string getRutaVideo() const = 0;
+    
+    std::string getInfo() const {
+        std::string info;
+        info.reserve(160);
+        escribirInfo(info);
+        return info;
+    }
+    
+    uint32_t getId() const { return id; }
+    AlmacenCatalogo::TipoVideo getTipoId() const { return almacen().tipo(id); }
+    const std::string& getTipo() const { return AlmacenCatalogo::nombreTipo(getTipoId()); }
+    uint32_t getGeneroId() const { return almacen().genero(id); }
+    uint32_t getDirectorId() const { return almacen().director(id); }
+    std::string getTitulo() const { return almacen().titulo(id); }
+    std::string getGenero() const { return textoInternado(almacen().genero(id)); }
+    std::string getRutaPortada() const {
+        return basePath + "portadas\\" + tituloANombreArchivo(almacen().titulo(id)) + ".jpg";
+    }
+    double getCalificacion() const { return almacen().calificacion(id); }
+    std::string getDirector() const { return textoInternado(almacen().director(id)); }
+    int getAnio() const { return almacen().anio(id); }
+    
+    void actualizarCalificacion(int nuevaCalificacion) {
+        almacen().setCalificacion(id, (getCalificacion() + nuevaCalificacion) / 2.0);
+    }
+    
+    void setCalificacion(double cal) {
+        almacen().setCalificacion(id, cal);
+    }
+    
+    void setGenero(const std::string& g) {
+        almacen().setGenero(id, g);
+    }
+    
+    static IndicePortadas& indicePortadas() {
+        static IndicePortadas indice(basePath + "portadas\\");
+        return indice;
+    }
+    
+    bool existePortada() const {
+        return indicePortadas().existe(tituloANombreArchivo(almacen().titulo(id)) + ".jpg");
+    }
+    
+    std::string getRutaPortadaODefault() const {
+        std::string rutaPortada = getRutaPortada();
+        if (existePortada()) {
+            return rutaPortada;
+        }
+        return basePath + "portadas\\default.jpg";
+    }
+
+    // Sobrecarga de operadores de comparación
+    bool operator<(const Video& other) const {
+        return getCalificacion() < other.getCalificacion();
+    }
+
+    bool operator>(const Video& other) const {
+        return getCalificacion() > other.getCalificacion();
+    }
+
+    bool operator==(const Video& other) const {
+        return almacen().titulo(id) == almacen().titulo(other.id);
+    }
+
+    bool operator!=(const Video& other) const {
+        return !(*this == other);
+    }
+};
+
+// Registro de una línea del archivo de datos (PELICULA|..., SERIE|..., etc.).
+// Los campos son vistas sobre el búfer del lector: solo son válidos hasta
+// la siguiente llamada a LectorRegistros::siguiente.
+struct RegistroDatos {
+    static constexpr size_t MAX_CAMPOS = 8;
+    std::string_view campos[MAX_CAMPOS];
+    size_t numCampos = 0;
+    std::string_view linea;
+    
+    std::string_view tipo() const {
+        return numCampos > 0 ? campos[0] : std::string_view();
+    }
+    
+    // Divide una línea por '|' y recorta espacios de cada campo, sin copiar
+    static void dividir(std::string_view linea, RegistroDatos& registro) {
+        registro.linea = linea;
+        registro.numCampos = 0;
+        size_t inicio = 0;
+        while (inicio < linea.size() && registro.numCampos < MAX_CAMPOS) {
+            size_t fin = linea.find('|', inicio);
+            if (fin == std::string_view::npos) fin = linea.size();
+            registro.campos[registro.numCampos++] = recortar(linea.substr(inicio, fin - inicio));
+            inicio = fin + 1;
+        }
+    }
+    
+    static std::string_view recortar(std::string_view campo) {
+        size_t a = campo.find_first_not_of(" \t");
+        if (a == std::string_view::npos) return std::string_view();
+        size_t b = campo.find_last_not_of(" \t");
+        return campo.substr(a, b - a + 1);
+    }
+};
+
+// Conversión numérica sin copias; lanza igual que std::stod/std::stoi
+inline double convertirDouble(std::string_view campo) {
+    if (!campo.empty() && campo[0] == '+') campo.remove_prefix(1);
+    double valor = 0;
+    auto res = std::from_chars(campo.data(), campo.data() + campo.size(), valor);
+    if (res.ec == std::errc::invalid_argument) throw std::invalid_argument("stod");
+    if (res.ec == std::errc::result_out_of_range) throw std::out_of_range("stod");
+    return valor;
+}
+
+inline int convertirEntero(std::string_view campo) {
+    if (!campo.empty() && campo[0] == '+') campo.remove_prefix(1);
+    int valor = 0;
+    auto res = std::from_chars(campo.data(), campo.data() + campo.size(), valor);
+    if (res.ec == std::errc::invalid_argument) throw std::invalid_argument("stoi");
+    if (res.ec == std::errc::result_out_of_range) throw std::out_of_range("stoi");
+    return valor;
+}
+
+// Archivo de solo lectura proyectado en memoria para importaciones grandes.
+// Si el sistema no permite mapearlo, valido() devuelve false y el llamador
+// debe recurrir a la lectura por flujo.
+class ArchivoMapeado {
+private:
+    const char* datos;
+    size_t tamano;
+    bool abierto;
+#ifdef _WIN32
+    HANDLE archivo;
+    HANDLE mapeo;
+#endif
+
+public:
+    explicit ArchivoMapeado(const std::string& ruta)
+        : datos(nullptr), tamano(0), abierto(false) {
+#ifdef _WIN32
+        mapeo = nullptr;
+        archivo = CreateFileA(ruta.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (archivo == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER tam;
+        if (!GetFileSizeEx(archivo, &tam)) return;
+        tamano = static_cast<size_t>(tam.QuadPart);
+        if (tamano == 0) { abierto = true; return; }
+        mapeo = CreateFileMappingA(archivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapeo) return;
+        datos = static_cast<const char*>(MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, 0));
+        abierto = datos != nullptr;
+#else
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            tamano = static_cast<size_t>(info.st_size);
+            if (tamano == 0) {
+                abierto = true;
+            } else {
+                void* p = mmap(nullptr, tamano, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, tamano, MADV_SEQUENTIAL);
+                    datos = static_cast<const char*>(p);
+                    abierto = true;
+                }
+            }
+        }
+        close(fd);
+#endif
+    }
+    
+    ~ArchivoMapeado() {
+#ifdef _WIN32
+        if (datos) UnmapViewOfFile(datos);
+        if (mapeo) CloseHandle(mapeo);
+        if (archivo != INVALID_HANDLE_VALUE) CloseHandle(archivo);
+#else
+        if (datos) munmap(const_cast<char*>(datos), tamano);
+#endif
+    }
+    
+    ArchivoMapeado(const ArchivoMapeado&) = delete;
+    ArchivoMapeado& operator=(const ArchivoMapeado&) = delete;
+    
+    bool valido() const { return abierto; }
+    size_t getTamano() const { return tamano; }
+    std::string_view contenido() const { return std::string_view(datos, datos ? tamano : 0); }
+};
+
+// Lector del formato delimitado por '|'. Trabaja sobre un bloque de memoria
+// completo (archivo mapeado) o lee un flujo por bloques en un búfer grande;
+// en ambos casos entrega cada línea como vistas, sin reservar memoria por
+// línea (el búfer solo crece si una línea no cabe en él).
+class LectorRegistros {
+private:
+    std::istream* entrada;
+    std::vector<char> bufer;
+    const char* base;
+    size_t inicio;
+    size_t fin;
+    bool finArchivo;
+    
+    bool siguienteLinea(std::string_view& linea) {
+        while (true) {
+            const void* salto = std::memchr(base + inicio, '\n', fin - inicio);
+            if (salto) {
+                size_t pos = static_cast<const char*>(salto) - base;
+                linea = std::string_view(base + inicio, pos - inicio);
+                inicio = pos + 1;
+                break;
+            }
+            if (finArchivo) {
+                if (inicio == fin) return false;
+                linea = std::string_view(base + inicio, fin - inicio);
+                inicio = fin;
+                break;
+            }
+            rellenar();
+        }
+        if (!linea.empty() && linea.back() == '\r') linea.remove_suffix(1);
+        return true;
+    }
+    
+    void rellenar() {
+        size_t pendiente = fin - inicio;
+        if (inicio > 0 && pendiente > 0) {
+            std::memmove(bufer.data(), bufer.data() + inicio, pendiente);
+        }
+        inicio = 0;
+        fin = pendiente;
+        if (fin == bufer.size()) {
+            bufer.resize(bufer.size() * 2);
+        }
+        base = bufer.data();
+        entrada->read(bufer.data() + fin, bufer.size() - fin);
+        std::streamsize leidos = entrada->gcount();
+        fin += static_cast<size_t>(leidos);
+        if (leidos == 0) finArchivo = true;
+    }
+
+public:
+    explicit LectorRegistros(std::istream& in, size_t tamBufer = 1 << 20)
+        : entrada(&in), bufer(tamBufer), base(bufer.data()),
+          inicio(0), fin(0), finArchivo(false) {}
+    
+    // Recorre directamente un bloque en memoria (p. ej. un ArchivoMapeado)
+    explicit LectorRegistros(std::string_view datos)
+        : entrada(nullptr), base(datos.data()), inicio(0), fin(datos.size()),
+          finArchivo(true) {}
+    
+    // Avanza al siguiente registro, saltando líneas vacías y comentarios
+    bool siguiente(RegistroDatos& registro) {
+        std::string_view linea;
+        while (siguienteLinea(linea)) {
+            if (linea.empty() || linea[0] == '#') continue;
+            RegistroDatos::dividir(linea, registro);
+            return true;
+        }
+        return false;
+    }
+};
+
+// Línea del archivo de datos ya clasificada y con sus números convertidos.
+// Se genera en paralelo por bloques y luego se aplica al catálogo en orden.
+// Guarda la línea (vista sobre los datos) y no sus campos: quien la aplica
+// la vuelve a dividir, así cada una ocupa 72 bytes aunque haya millones en
+// vuelo.
+struct OperacionDatos {
+    enum Tipo : uint8_t { IGNORADA, CALIFICACION, PELICULA, SERIE, EPISODIO, USUARIO_CALIFICACION, GENERO, ERROR };
+    
+    Tipo tipo = IGNORADA;
+    bool visto = false;
+    int duracion = 0;
+    int anio = 0;
+    int episodiosPorTemporada = 0;
+    int numTemporadas = 0;
+    int totalEpisodios = 0;
+    int temporada = 0;
+    int episodio = 0;
+    int calificacionUsuario = 0;
+    double calificacion = 0;
+    std::string_view linea;
+    const char* error = nullptr;    // texto fijo, sólo con tipo ERROR
+    
+    static OperacionDatos interpretar(const RegistroDatos& registro) {
+        OperacionDatos op;
+        op.linea = registro.linea;
+        const auto& partes = registro.campos;
+        std::string_view tipo = registro.tipo();
+        size_t numPartes = registro.numCampos;
+        
+        try {
+            if (tipo == "CALIFICACION" && numPartes >= 3) {
+                op.calificacion = convertirDouble(partes[2]);
+                op.tipo = CALIFICACION;
+            }
+            else if (tipo == "PELICULA" && numPartes >= 7) {
+                op.calificacion = convertirDouble(partes[2]);
+                op.duracion = convertirEntero(partes[3]);
+                op.anio = convertirEntero(partes[6]);
+                op.tipo = PELICULA;
+            }
+            else if (tipo == "SERIE" && numPartes >= 8) {
+                op.calificacion = convertirDouble(partes[2]);
+                op.episodiosPorTemporada = convertirEntero(partes[3]);
+                op.numTemporadas = convertirEntero(partes[5]);
+                op.totalEpisodios = convertirEntero(partes[6]);
+                op.tipo = SERIE;
+            }
+            // EPISODIO|Serie|Temporada|Episodio|Duración|Ruta|Visto (ruta y visto opcionales)
+            else if (tipo == "EPISODIO" && numPartes >= 5) {
+                op.temporada = convertirEntero(partes[2]);
+                op.episodio = convertirEntero(partes[3]);
+                op.duracion = partes[4].empty() ? 0 : convertirEntero(partes[4]);
+                op.visto = numPartes >= 7 && !partes[6].empty() && convertirEntero(partes[6]) != 0;
+                op.tipo = EPISODIO;
+            }
+            else if (tipo == "USUARIO_CALIFICACION" && numPartes >= 4) {
+                op.calificacionUsuario = convertirEntero(partes[3]);
+                op.tipo = USUARIO_CALIFICACION;
+            }
+            else if (tipo == "GENERO" && numPartes >= 3) {
+                op.tipo = GENERO;
+            }
+        }
+        catch (const std::invalid_argument&) {
+            op.tipo = ERROR;
+            op.error = "número inválido";
+        }
+        catch (const std::out_of_range&) {
+            op.tipo = ERROR;
+            op.error = "número fuera de rango";
+        }
+        return op;
+    }
+};
+
+// Interpreta en el pool los bloques (alineados a fin de línea) de datos y
+// llama a aplicar(op) en el hilo que llama, línea por línea y en orden de
+// archivo: el resultado es el de la lectura secuencial. Se trabaja con dos
+// ventanas de bloques para que, mientras se aplica una, el pool ya
+// interprete la siguiente; la memoria en vuelo queda acotada por el tamaño
+// de las ventanas. Las operaciones apuntan a datos.
+template <typename Aplicar>
+void importarEnParalelo(std::string_view datos, PoolHilos& pool, Aplicar aplicar) {
+    const size_t TAM_BLOQUE = 256 << 10;
+    const size_t bloquesPorVentana = std::min<size_t>(64, pool.getNumHilos() * 4);
+    
+    struct Ventana {
+        std::vector<std::string_view> bloques;
+        std::vector<std::vector<OperacionDatos>> lotes;
+    };
+    Ventana ventanas[2];
+    size_t pos = 0;
+    
+    auto llenar = [&](Ventana& ventana) {
+        ventana.bloques.clear();
+        while (ventana.bloques.size() < bloquesPorVentana && pos < datos.size()) {
+            size_t fin = pos + TAM_BLOQUE;
+            if (fin >= datos.size()) {
+                fin = datos.size();
+            } else {
+                size_t salto = datos.find('\n', fin - 1);
+                fin = salto == std::string_view::npos ? datos.size() : salto + 1;
+            }
+            ventana.bloques.push_back(datos.substr(pos, fin - pos));
+            pos = fin;
+        }
+        if (ventana.lotes.size() < ventana.bloques.size()) ventana.lotes.resize(ventana.bloques.size());
+        return pool.lanzar(ventana.bloques.size(), [&ventana](size_t i) {
+            std::vector<OperacionDatos>& lote = ventana.lotes[i];
+            lote.clear();
+            LectorRegistros lector(ventana.bloques[i]);
+            RegistroDatos registro;
+            while (lector.siguiente(registro)) lote.push_back(OperacionDatos::interpretar(registro));
+        });
+    };
+    
+    auto interpretando = llenar(ventanas[0]);
+    for (size_t actual = 0; !ventanas[actual].bloques.empty(); actual ^= 1) {
+        interpretando->esperar();
+        interpretando = llenar(ventanas[actual ^ 1]);
+        const Ventana& ventana = ventanas[actual];
+        for (size_t i = 0; i < ventana.bloques.size(); i++) {
+            for (const auto& op : ventana.lotes[i]) aplicar(op);
+        }
+    }
+}
+
+// Índice de títulos para búsquedas O(1) sobre el catálogo
+using IndiceTitulos = std::unordered_map<std::string, std::shared_ptr<Video>>;
+
+// Fuerza a disco lo escrito en un FILE* (fflush + fsync)
+inline bool sincronizarArchivo(FILE* archivo) {
+    if (std::fflush(archivo) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(archivo)) == 0;
+#else
+    return fsync(fileno(archivo)) == 0;
+#endif
+}
+
+// Suma de verificación FNV-1a de 32 bits para detectar registros truncados
+inline uint32_t sumaVerificacion(const char* datos, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= static_cast<unsigned char>(datos[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Clase para manejar el historial de calificaciones.
+// El archivo de texto es la instantánea; cada calificación nueva se agrega a
+// una bitácora binaria (rutaHistorial + ".log") que un hilo escritor vuelca a
+// disco en lotes con un solo fsync. Al superar umbralCompactacion bytes, la
+// bitácora se compacta en una nueva instantánea. Al iniciar se lee la
+// instantánea y después se reproduce la bitácora.
+//
+// Cada instantánea de texto lleva en su cabecera una época ("# Epoca: N")
+// que crece en uno con cada reescritura; así la instantánea binaria del
+// catálogo sabe si se escribió junto con la instantánea de texto vigente.
+//
+// Formato de cada registro de la bitácora:
+//   u32 suma | u16 longitud | título | f64 calificación | i64 marca de tiempo
+class HistorialManager {
+private:
+    // Trabajo pendiente del hilo escritor, en el orden en que se pidió
+    // Una instantánea lleva los títulos separados por '\0' en datos y las
+    // calificaciones en el mismo orden; el texto lo arma el hilo escritor
+    struct ComandoEscritura {
+        bool esInstantanea;
+        std::string datos;
+        std::vector<float> calificaciones;
+    };
+    
+    std::string rutaHistorial;
+    std::string rutaBitacora;
+    size_t umbralCompactacion;
+    
+    std::thread hiloEscritor;
+    std::mutex mutexEscritura;
+    std::condition_variable hayTrabajo;
+    std::condition_variable trabajoTerminado;
+    std::deque<ComandoEscritura> cola;
+    uint64_t comandosEncolados;
+    uint64_t comandosTerminados;
+    size_t bytesBitacora;
+    uint64_t epoca;             // de la última instantánea leída o escrita
+    bool detenerEscritor;
+    
+    std::string obtenerFechaHora() {
+        time_t now = time(0);
+        char* dt = ctime(&now);
+        std::string fecha(dt);
+        fecha.pop_back(); // Remover el \n del final
+        return fecha;
+    }
+
+public:
+    HistorialManager(const std::string& ruta = "C:\\Users\\DiegoB\\Desktop\\Netflix_piraton\\historialDatos.txt",
+                     size_t umbral = 1 << 20) 
+        : rutaHistorial(ruta), rutaBitacora(ruta + ".log"), umbralCompactacion(umbral),
+          comandosEncolados(0), comandosTerminados(0), bytesBitacora(0), epoca(0),
+          detenerEscritor(false) {}
+    
+    ~HistorialManager() {
+        if (hiloEscritor.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutexEscritura);
+                detenerEscritor = true;
+            }
+            hayTrabajo.notify_all();
+            hiloEscritor.join();
+        }
+    }
+    
+    HistorialManager(const HistorialManager&) = delete;
+    HistorialManager& operator=(const HistorialManager&) = delete;
+    
+    const std::string& getRutaHistorial() const { return rutaHistorial; }
+    
+    // Cargar calificaciones: instantánea de texto y luego la cola de la bitácora
+    void cargarHistorial(const IndiceTitulos& indice) {
+        if (!aplicarInstantanea(indice)) {
+            // Si no existe el archivo, lo creamos con datos iniciales
+            crearArchivoInicial();
+        }
+        reproducirBitacora(indice);
+    }
+    
+    // Aplica las calificaciones de la instantánea de texto; false si no existe
+    bool aplicarInstantanea(const IndiceTitulos& indice) {
+        std::ifstream archivo(rutaHistorial, std::ios::binary);
+        if (!archivo.is_open()) return false;
+        
+        LectorRegistros lector(archivo);
+        RegistroDatos registro;
+        std::string titulo;
+        while (lector.siguiente(registro)) {
+            if (registro.numCampos >= 3 && registro.tipo() == "CALIFICACION") {
+                titulo.assign(registro.campos[1]);
+                double calificacion = convertirDouble(registro.campos[2]);
+                
+                // Buscar el video en el catálogo y actualizar su calificación
+                auto it = indice.find(titulo);
+                if (it != indice.end() && it->second) {
+                    it->second->setCalificacion(calificacion);
+                }
+            }
+        }
+        return true;
+    }
+    
+    // Lee solo la cabecera de la instantánea de texto. Un historial sin
+    // época (anterior a ella, o inexistente) es la época 0.
+    uint64_t leerEpoca() {
+        uint64_t leida = 0;
+        std::ifstream archivo(rutaHistorial, std::ios::binary);
+        std::string linea;
+        while (std::getline(archivo, linea)) {
+            if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+            if (linea.empty()) continue;
+            if (linea[0] != '#') break;
+            if (linea.rfind("# Epoca: ", 0) == 0) {
+                leida = std::strtoull(linea.c_str() + 9, nullptr, 10);
+                break;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutexEscritura);
+        epoca = leida;
+        return leida;
+    }
+    
+    // Época de la instantánea de texto que está en disco
+    uint64_t getEpoca() {
+        std::lock_guard<std::mutex> lock(mutexEscritura);
+        return epoca;
+    }
+    
+    // Agrega la calificación a la bitácora; el hilo escritor la hace durable
+    // junto con las demás que lleguen antes del siguiente fsync
+    void guardarCalificacion(const std::string& titulo, double nuevaCalificacion) {
+        uint16_t longitud = static_cast<uint16_t>(std::min<size_t>(titulo.size(), UINT16_MAX));
+        int64_t marcaTiempo = static_cast<int64_t>(time(0));
+        
+        std::string registro(sizeof(uint32_t), '\0');
+        registro.append(reinterpret_cast<const char*>(&longitud), sizeof(longitud));
+        registro.append(titulo.data(), longitud);
+        registro.append(reinterpret_cast<const char*>(&nuevaCalificacion), sizeof(nuevaCalificacion));
+        registro.append(reinterpret_cast<const char*>(&marcaTiempo), sizeof(marcaTiempo));
+        uint32_t suma = sumaVerificacion(registro.data() + sizeof(uint32_t),
+                                         registro.size() - sizeof(uint32_t));
+        std::memcpy(&registro[0], &suma, sizeof(suma));
+        
+        encolar({false, std::move(registro), {}});
+    }
+    
+    // Escribe una instantánea completa si la bitácora ya creció demasiado
+    void compactarSiNecesario(const std::vector<std::shared_ptr<Video>>& catalogo) {
+        {
+            std::lock_guard<std::mutex> lock(mutexEscritura);
+            if (bytesBitacora < umbralCompactacion) return;
+        }
+        encolar(copiarInstantanea(catalogo));
+    }
+    
+    // Reescribe la instantánea con el estado actual y vacía la bitácora;
+    // espera a que todo quede en disco
+    void actualizarHistorialCompleto(const std::vector<std::shared_ptr<Video>>& catalogo) {
+        uint64_t ticket = encolar(copiarInstantanea(catalogo));
+        std::unique_lock<std::mutex> lock(mutexEscritura);
+        trabajoTerminado.wait(lock, [&] { return comandosTerminados >= ticket; });
+    }
+
+private:
+    // En el hilo de la interfaz solo se copian títulos y calificaciones del
+    // almacén: dos bloques contiguos, sin dar formato
+    static ComandoEscritura copiarInstantanea(const std::vector<std::shared_ptr<Video>>& catalogo) {
+        const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+        ComandoEscritura comando{true, std::string(), {}};
+        size_t bytes = 0;
+        for (const auto& video : catalogo) {
+            if (video) bytes += almacen.titulo(video->getId()).size() + 1;
+        }
+        comando.datos.reserve(bytes);
+        comando.calificaciones.reserve(catalogo.size());
+        for (const auto& video : catalogo) {
+            if (!video) continue;
+            comando.datos += almacen.titulo(video->getId());
+            comando.datos += '\0';
+            comando.calificaciones.push_back(almacen.calificacion(video->getId()));
+        }
+        return comando;
+    }
+    
+    // Se ejecuta en el hilo escritor
+    std::string generarInstantanea(const ComandoEscritura& comando, uint64_t epocaNueva) {
+        std::ostringstream archivo;
+        archivo << "# Historial de calificaciones - Netflix Piratón\n";
+        archivo << "# Formato: CALIFICACION|Título del Video|Nueva Calificación|Fecha y Hora\n";
+        archivo << "# Este archivo se actualiza automáticamente cuando calificas videos\n";
+        archivo << "# Epoca: " << epocaNueva << "\n\n";
+        archivo << "# Calificaciones actualizadas - " << obtenerFechaHora() << "\n";
+        
+        std::string_view titulos = comando.datos;
+        for (double calificacion : comando.calificaciones) {
+            size_t fin = titulos.find('\0');
+            archivo << "CALIFICACION|" << titulos.substr(0, fin) << "|" 
+                   << calificacion << "\n";
+            titulos.remove_prefix(fin + 1);
+        }
+        return archivo.str();
+    }
+    
+    uint64_t encolar(ComandoEscritura comando) {
+        std::lock_guard<std::mutex> lock(mutexEscritura);
+        if (!hiloEscritor.joinable()) {
+            hiloEscritor = std::thread([this] { escribirPendientes(); });
+        }
+        if (comando.esInstantanea) {
+            bytesBitacora = 0;
+        } else {
+            bytesBitacora += comando.datos.size();
+        }
+        cola.push_back(std::move(comando));
+        hayTrabajo.notify_one();
+        return ++comandosEncolados;
+    }
+    
+    // Hilo escritor: agrupa todos los registros pendientes en una sola
+    // escritura + fsync (group commit); las instantáneas se aplican en orden,
+    // así ningún registro posterior a la instantánea se pierde al truncar
+    void escribirPendientes() {
+        std::unique_lock<std::mutex> lock(mutexEscritura);
+        while (true) {
+            hayTrabajo.wait(lock, [this] { return detenerEscritor || !cola.empty(); });
+            if (cola.empty()) return;
+            
+            std::vector<ComandoEscritura> lote;
+            if (cola.front().esInstantanea) {
+                lote.push_back(std::move(cola.front()));
+                cola.pop_front();
+            } else {
+                while (!cola.empty() && !cola.front().esInstantanea) {
+                    lote.push_back(std::move(cola.front()));
+                    cola.pop_front();
+                }
+            }
+            // Solo este hilo cambia la época una vez iniciado
+            uint64_t epocaNueva = epoca + 1;
+            bool instantaneaEscrita = false;
+            lock.unlock();
+            
+            if (lote.front().esInstantanea) {
+                instantaneaEscrita = escribirInstantanea(generarInstantanea(lote.front(), epocaNueva));
+            } else {
+                if (FILE* bitacora = std::fopen(rutaBitacora.c_str(), "ab")) {
+                    for (const auto& comando : lote) {
+                        std::fwrite(comando.datos.data(), 1, comando.datos.size(), bitacora);
+                    }
+                    sincronizarArchivo(bitacora);
+                    std::fclose(bitacora);
+                }
+            }
+            
+            lock.lock();
+            if (instantaneaEscrita) epoca = epocaNueva;
+            comandosTerminados += lote.size();
+            trabajoTerminado.notify_all();
+        }
+    }
+    
+    // Escribe la instantánea en un temporal, la sustituye de forma atómica y
+    // solo entonces vacía la bitácora. Si se interrumpe entre ambos pasos, la
+    // bitácora se vuelve a aplicar sin efecto porque guarda valores absolutos.
+    bool escribirInstantanea(const std::string& contenido) {
+        std::string rutaTemporal = rutaHistorial + ".tmp";
+        FILE* archivo = std::fopen(rutaTemporal.c_str(), "w");
+        if (!archivo) return false;
+        bool escrito = std::fwrite(contenido.data(), 1, contenido.size(), archivo) == contenido.size();
+        escrito = sincronizarArchivo(archivo) && escrito;
+        std::fclose(archivo);
+        
+        std::error_code ec;
+        if (!escrito) {
+            std::filesystem::remove(rutaTemporal, ec);
+            return false;
+        }
+        std::filesystem::rename(rutaTemporal, rutaHistorial, ec);
+        if (ec) return false;
+        std::filesystem::resize_file(rutaBitacora, 0, ec);
+        return true;
+    }
+    
+public:
+    // Aplica los registros válidos de la bitácora; una cola corrupta (p. ej.
+    // por un corte de luz a mitad de escritura) se descarta y se trunca
+    void reproducirBitacora(const IndiceTitulos& indice) {
+        size_t validos = 0;
+        size_t tamano = 0;
+        {
+            ArchivoMapeado mapeo(rutaBitacora);
+            if (!mapeo.valido()) return;
+            std::string_view datos = mapeo.contenido();
+            tamano = datos.size();
+            std::string titulo;
+            
+            const size_t cabecera = sizeof(uint32_t) + sizeof(uint16_t);
+            const size_t pie = sizeof(double) + sizeof(int64_t);
+            while (tamano - validos >= cabecera) {
+                const char* p = datos.data() + validos;
+                uint32_t suma;
+                uint16_t longitud;
+                std::memcpy(&suma, p, sizeof(suma));
+                std::memcpy(&longitud, p + sizeof(suma), sizeof(longitud));
+                size_t total = cabecera + longitud + pie;
+                if (tamano - validos < total) break;
+                if (sumaVerificacion(p + sizeof(suma), total - sizeof(suma)) != suma) break;
+                
+                double calificacion;
+                std::memcpy(&calificacion, p + cabecera + longitud, sizeof(calificacion));
+                titulo.assign(p + cabecera, longitud);
+                auto it = indice.find(titulo);
+                if (it != indice.end() && it->second) {
+                    it->second->setCalificacion(calificacion);
+                }
+                validos += total;
+            }
+        }
+        
+        if (validos < tamano) {
+            std::error_code ec;
+            std::filesystem::resize_file(rutaBitacora, validos, ec);
+        }
+        bytesBitacora = validos;
+    }
+
+private:
+    void crearArchivoInicial() {
+        std::ofstream archivo(rutaHistorial);
+        if (archivo.is_open()) {
+            archivo << "# Historial de calificaciones - Netflix Piratón\n";
+            archivo << "# Formato: CALIFICACION|Título del Video|Nueva Calificación|Fecha y Hora\n";
+            archivo << "# Este archivo se actualiza automáticamente cuando calificas videos\n";
+            archivo << "# Epoca: 0\n\n";
+            archivo << "# Datos iniciales del catálogo (calificaciones base)\n";
+            
+            // Calificaciones iniciales
+            archivo << "CALIFICACION|La princesa Mononoke|8.4\n";
+            archivo << "CALIFICACION|El viaje de Chihiro|8.6\n";
+            archivo << "CALIFICACION|Look Back|8.1\n";
+            archivo << "CALIFICACION|Star Wars Episodio I La amenaza fantasma|6.5\n";
+            archivo << "CALIFICACION|Star Wars Episodio II El ataque de los clones|6.5\n";
+            archivo << "CALIFICACION|Star Wars Episodio III La venganza de los Sith|7.5\n";
+            archivo << "CALIFICACION|Star Wars Episodio IV Una nueva esperanza|8.6\n";
+            archivo << "CALIFICACION|Star Wars Episodio V El imperio contraataca|8.7\n";
+            archivo << "CALIFICACION|Star Wars Episodio VI El retorno del Jedi|8.3\n";
+            archivo << "CALIFICACION|Jujutsu Kaisen|8.7\n";
+            archivo << "CALIFICACION|Pokemon|7.5\n";
+            archivo << "CALIFICACION|Violet Evergarden|8.8\n";
+            archivo << "CALIFICACION|Kimetsu no Yaiba|8.7\n";
+            archivo << "CALIFICACION|Attack on Titan|9.0\n";
+            archivo << "CALIFICACION|Blue Lock|8.3\n";
+            archivo << "CALIFICACION|Star Wars The Clone Wars|8.4\n";
+            archivo << "CALIFICACION|Ann|7.9\n";
+            archivo << "CALIFICACION|Nadie nos va a extrañar|8.1\n";
+            archivo << "CALIFICACION|Si la vida te da mandarinas|7.8\n";
+            archivo << "CALIFICACION|Goblin|8.9\n";
+            archivo << "CALIFICACION|Alien Stage|8.5\n";
+            
+            archivo.close();
+        }
+    }
+};
+
+// Clase derivada Película
+class Pelicula : public Video {
+public:
+    Pelicula(const std::string& t, double cal, int d, const std::string& g, 
+             const std::string& dir, int a)
+        : Video(AlmacenCatalogo::PELICULA, t, cal, g, dir, a) {
+        almacen().setDatosPelicula(id, d);
+    }
+    
+    void escribirInfo(std::string& destino) const override {
+        destino += "Película: ";
+        destino += getTitulo();
+        destino += " | Género: ";
+        destino += getGenero();
+        destino += " | Duración: ";
+        agregarEntero(destino, getDuracion());
+        destino += " min | Director: ";
+        destino += getDirector();
+        destino += " | Año: ";
+        agregarEntero(destino, getAnio());
+        destino += " | Calificación: ";
+        agregarDecimal(destino, getCalificacion(), 1);
+    }
+    
+    std::string getRutaVideo() const override {
+        std::string nombreArchivo = tituloANombreArchivo(almacen().titulo(id));
+        return basePath + "videos\\peliculas\\" + nombreArchivo + ".mp4";
+    }
+    
+    int getDuracion() const { return almacen().duracion(id); }
+};
+
+// Clase derivada Serie
+class Serie : public Video {
+public:
+    Serie(const std::string& t, double cal, int ept, const std::string& g, 
+          int nt, int te, const std::string& dir)
+        : Video(AlmacenCatalogo::SERIE, t, cal, g, dir, 0) {
+        almacen().setDatosSerie(id, ept, nt, te);
+    }
+    
+    void escribirInfo(std::string& destino) const override {
+        destino += "Serie: ";
+        destino += getTitulo();
+        destino += " | Género: ";
+        destino += getGenero();
+        destino += " | Temporadas: ";
+        agregarEntero(destino, getNumTemporadas());
+        destino += " | Episodios: ";
+        agregarEntero(destino, getTotalEpisodios());
+        destino += " | Director: ";
+        destino += getDirector();
+        destino += " | Calificación: ";
+        agregarDecimal(destino, getCalificacion(), 1);
+    }
+    
+    std::string getRutaVideo() const override {
+        std::string nombreArchivo = tituloANombreArchivo(almacen().titulo(id));
+        return basePath + "videos\\series\\" + nombreArchivo + "_s1e1.mp4";
+    }
+    
+    int getEpisodiosPorTemporada() const { return almacen().episodiosTemporada(id); }
+    int getNumTemporadas() const { return almacen().temporadas(id); }
+    int getTotalEpisodios() const { return almacen().episodios(id); }
+    
+    // Un episodio de la serie. Se arma al pedirlo: desde el detalle de
+    // episodios si la serie lo tiene, o calculado si sus temporadas son
+    // uniformes
+    struct Episodio {
+        int temporada;  // desde 1
+        int numero;     // dentro de la temporada, desde 1
+        int global;     // en toda la serie, desde 1
+        int duracion;   // minutos; 0 si no se conoce
+        bool visto;
+        
+        // "T2E5 - Episodio 15 - 42 min - visto" en destino, sin reservar memoria
+        int escribir(char* destino, size_t tam) const {
+            int n = std::snprintf(destino, tam, "T%dE%d - Episodio %d", temporada, numero, global);
+            if (duracion > 0 && n >= 0 && static_cast<size_t>(n) < tam) {
+                n += std::snprintf(destino + n, tam - n, " - %d min", duracion);
+            }
+            if (visto && n >= 0 && static_cast<size_t>(n) < tam) {
+                n += std::snprintf(destino + n, tam - n, " - visto");
+            }
+            return n;
+        }
+        
+        std::string etiqueta() const {
+            char texto[64];
+            escribir(texto, sizeof(texto));
+            return texto;
+        }
+        
+        // "s2e5", como se nombran los archivos de los episodios
+        std::string sufijoArchivo() const {
+            return "s" + std::to_string(temporada) + "e" + std::to_string(numero);
+        }
+    };
+    
+    // Tramo [desde, hasta) de episodios que se recorre sin crear ninguno de antemano
+    class RangoEpisodios {
+    private:
+        const Serie* serie;
+        int desde, hasta;
+    
+    public:
+        class iterator {
+        private:
+            const Serie* serie;
+            int indice;
+        
+        public:
+            iterator(const Serie* s, int i) : serie(s), indice(i) {}
+            Episodio operator*() const { return serie->getEpisodio(indice); }
+            iterator& operator++() { indice++; return *this; }
+            bool operator!=(const iterator& otro) const { return indice != otro.indice; }
+            bool operator==(const iterator& otro) const { return indice == otro.indice; }
+        };
+        
+        RangoEpisodios(const Serie* s, int d, int h) : serie(s), desde(d), hasta(h) {}
+        iterator begin() const { return iterator(serie, desde); }
+        iterator end() const { return iterator(serie, hasta); }
+        int size() const { return hasta - desde; }
+    };
+    
+    // Episodios cargados con registros EPISODIO; nullptr si la serie sólo
+    // tiene la distribución uniforme de su registro SERIE
+    const EpisodiosSerie* getDetalleEpisodios() const {
+        const EpisodiosSerie* detalle = almacen().getDetalleEpisodios(id);
+        return detalle && !detalle->empty() ? detalle : nullptr;
+    }
+    
+    // Agrega o actualiza un episodio. Desde ese momento la serie usa su
+    // distribución real, y sus totales pasan a ser los del detalle.
+    void agregarEpisodio(int temporada, int numero, int duracion, std::string_view ruta, bool visto) {
+        EpisodiosSerie& detalle = almacen().detalleEpisodiosDe(id);
+        detalle.agregar(temporada, numero, duracion, ruta, visto);
+        almacen().setDatosSerie(id, getEpisodiosPorTemporada(), detalle.getNumTemporadas(),
+                                static_cast<int>(detalle.size()));
+    }
+    
+    // Episodios que existen. Sin detalle: el total declarado, sin pasar de
+    // lo que caben en las temporadas, como al recorrerlas una por una.
+    int getCantidadEpisodios() const {
+        if (const EpisodiosSerie* detalle = getDetalleEpisodios()) return static_cast<int>(detalle->size());
+        long long porTemporada = getEpisodiosPorTemporada();
+        if (porTemporada <= 0 || getNumTemporadas() <= 0) return 0;
+        long long caben = porTemporada * getNumTemporadas();
+        return static_cast<int>(std::max(0LL, std::min<long long>(getTotalEpisodios(), caben)));
+    }
+    
+    // Episodio en la posición indice (desde 0) de la serie
+    Episodio getEpisodio(int indice) const {
+        if (const EpisodiosSerie* detalle = getDetalleEpisodios()) {
+            const EpisodiosSerie::Entrada& e = (*detalle)[indice];
+            return { e.temporada, e.numero, indice + 1, e.duracion, e.visto != 0 };
+        }
+        int porTemporada = getEpisodiosPorTemporada();
+        return { indice / porTemporada + 1, indice % porTemporada + 1, indice + 1, 0, false };
+    }
+    
+    // Posición del episodio de esa temporada y número, o -1 si no existe
+    int buscarEpisodio(int temporada, int numero) const {
+        if (const EpisodiosSerie* detalle = getDetalleEpisodios()) {
+            return static_cast<int>(detalle->buscar(temporada, numero));
+        }
+        if (temporada < 1 || numero < 1 || numero > getEpisodiosPorTemporada()) return -1;
+        long long posicion = static_cast<long long>(temporada - 1) * getEpisodiosPorTemporada() + numero - 1;
+        return posicion < getCantidadEpisodios() ? static_cast<int>(posicion) : -1;
+    }
+    
+    // Posición (desde 0) del primer episodio de la temporada
+    int primerEpisodioDe(int temporada) const {
+        if (const EpisodiosSerie* detalle = getDetalleEpisodios()) {
+            return static_cast<int>(detalle->primeroDe(temporada));
+        }
+        long long posicion = static_cast<long long>(temporada - 1) * getEpisodiosPorTemporada();
+        return static_cast<int>(std::max(0LL, std::min<long long>(posicion, getCantidadEpisodios())));
+    }
+    
+    RangoEpisodios getEpisodios(int desde = 0, int hasta = -1) const {
+        int cantidad = getCantidadEpisodios();
+        if (hasta < 0 || hasta > cantidad) hasta = cantidad;
+        desde = std::max(0, std::min(desde, hasta));
+        return RangoEpisodios(this, desde, hasta);
+    }
+    
+    // Ruta del archivo del episodio: la del registro EPISODIO si la trae, o
+    // la de por defecto, videos\series\<nombre>_s<T>e<E>.mp4
+    std::string getRutaEpisodio(int indice) const {
+        if (const EpisodiosSerie* detalle = getDetalleEpisodios()) {
+            std::string_view ruta = detalle->ruta(indice);
+            if (!ruta.empty()) return std::string(ruta);
+        }
+        return ".\\videos\\series\\" + tituloANombreArchivo(almacen().titulo(id)) + "_" +
+               getEpisodio(indice).sufijoArchivo() + ".mp4";
+    }
+    
+    // Sólo queda registrado si la serie tiene detalle de episodios
+    void marcarVisto(int indice) {
+        if (getDetalleEpisodios()) almacen().detalleEpisodiosDe(id).setVisto(indice, true);
+    }
+    
+    std::string getEpisodiosInfo() const {
+        std::ostringstream oss;
+        for (const Episodio& episodio : getEpisodios()) {
+            oss << "T" << episodio.temporada << "E" << episodio.numero << ": Episodio " << episodio.global << "\n";
+        }
+        return oss.str();
+    }
+};
+
+// Firma de un archivo (tamaño y fecha de modificación); 0 si no existe
+inline uint64_t firmaArchivo(const std::string& ruta) {
+    std::error_code ec;
+    auto tamano = std::filesystem::file_size(ruta, ec);
+    if (ec) return 0;
+    auto fecha = std::filesystem::last_write_time(ruta, ec);
+    if (ec) return 0;
+    uint64_t ticks = static_cast<uint64_t>(fecha.time_since_epoch().count());
+    return (ticks * 1099511628211ull) ^ static_cast<uint64_t>(tamano);
+}
+
+// Instantánea binaria del catálogo para arrancar sin volver a parsear texto.
+// Formato (versión 3): cabecera | registros de ancho fijo | episodios |
+// tabla de cadenas. Los registros guardan desplazamientos a la tabla de
+// cadenas, que no repite géneros ni directores. Los episodios detallados de
+// las series van en orden de registro. La cabecera guarda la época del
+// historial de texto con el que se escribió; si el historial se reescribió
+// después (una compactación a mitad de sesión), los títulos siguen valiendo
+// pero las calificaciones hay que tomarlas del historial. Las versiones 1
+// y 2 guardaban en ese campo la firma del archivo de texto y se leen como
+// si su época no coincidiera; la 1 no tiene episodios (numEpisodios era
+// reservado y valía 0).
+class InstantaneaCatalogo {
+private:
+    static constexpr uint32_t VERSION = 3;
+    
+    struct Cabecera {
+        char magia[8];
+        uint32_t version;
+        uint32_t numRegistros;
+        uint64_t epocaHistorial;
+        uint64_t tamCadenas;
+        uint32_t suma;
+        uint32_t numEpisodios;
+    };
+    
+    struct Registro {
+        uint32_t titulo, longTitulo;
+        uint32_t genero, longGenero;
+        uint32_t director, longDirector;
+        uint32_t tipo;
+        int32_t anio;
+        double calificacion;
+        int32_t duracion;
+        int32_t episodiosPorTemporada;
+        int32_t numTemporadas;
+        int32_t totalEpisodios;
+    };
+    
+    struct RegistroEpisodio {
+        uint32_t registro;      // posición del registro de la serie
+        uint16_t temporada;
+        uint16_t numero;
+        uint16_t duracion;
+        uint16_t visto;
+        uint32_t ruta, longRuta;
+    };
+    
+    enum { TIPO_PELICULA = 0, TIPO_SERIE = 1 };
+    
+    static const char* magia() { return "NPCATAL"; }
+
+public:
+    static bool guardar(const std::string& ruta, 
+                        const std::vector<std::shared_ptr<Video>>& catalogo,
+                        uint64_t epocaHistorial) {
+        std::vector<Registro> registros;
+        std::vector<RegistroEpisodio> episodios;
+        std::string cadenas;
+        std::unordered_map<std::string, uint32_t> desplazamientos;
+        auto agregarCadena = [&](const std::string& texto, uint32_t& desp, uint32_t& longitud) {
+            auto it = desplazamientos.find(texto);
+            if (it == desplazamientos.end()) {
+                it = desplazamientos.emplace(texto, static_cast<uint32_t>(cadenas.size())).first;
+                cadenas += texto;
+            }
+            desp = it->second;
+            longitud = static_cast<uint32_t>(texto.size());
+        };
+        
+        registros.reserve(catalogo.size());
+        for (const auto& video : catalogo) {
+            if (!video) continue;
+            Registro r = {};
+            agregarCadena(video->getTitulo(), r.titulo, r.longTitulo);
+            agregarCadena(video->getGenero(), r.genero, r.longGenero);
+            agregarCadena(video->getDirector(), r.director, r.longDirector);
+            r.anio = video->getAnio();
+            r.calificacion = video->getCalificacion();
+            if (video->getTipoId() == AlmacenCatalogo::PELICULA) {
+                r.tipo = TIPO_PELICULA;
+                r.duracion = static_cast<const Pelicula&>(*video).getDuracion();
+            } else {
+                const Serie& serie = static_cast<const Serie&>(*video);
+                r.tipo = TIPO_SERIE;
+                r.episodiosPorTemporada = serie.getEpisodiosPorTemporada();
+                r.numTemporadas = serie.getNumTemporadas();
+                r.totalEpisodios = serie.getTotalEpisodios();
+                if (const EpisodiosSerie* detalle = serie.getDetalleEpisodios()) {
+                    for (size_t i = 0; i < detalle->size(); i++) {
+                        const EpisodiosSerie::Entrada& e = (*detalle)[i];
+                        RegistroEpisodio re = {};
+                        re.registro = static_cast<uint32_t>(registros.size());
+                        re.temporada = e.temporada;
+                        re.numero = e.numero;
+                        re.duracion = e.duracion;
+                        re.visto = e.visto;
+                        agregarCadena(std::string(detalle->ruta(i)), re.ruta, re.longRuta);
+                        episodios.push_back(re);
+                    }
+                }
+            }
+            registros.push_back(r);
+        }
+        
+        Cabecera cab = {};
+        std::memcpy(cab.magia, magia(), sizeof(cab.magia));
+        cab.version = VERSION;
+        cab.numRegistros = static_cast<uint32_t>(registros.size());
+        cab.epocaHistorial = epocaHistorial;
+        cab.tamCadenas = cadenas.size();
+        cab.numEpisodios = static_cast<uint32_t>(episodios.size());
+        uint32_t sumaRegistros = sumaVerificacion(reinterpret_cast<const char*>(registros.data()),
+                                                  registros.size() * sizeof(Registro));
+        cab.suma = sumaRegistros ^ sumaVerificacion(cadenas.data(), cadenas.size());
+        if (!episodios.empty()) {
+            cab.suma ^= sumaVerificacion(reinterpret_cast<const char*>(episodios.data()),
+                                         episodios.size() * sizeof(RegistroEpisodio));
+        }
+        
+        std::string rutaTemporal = ruta + ".tmp";
+        FILE* archivo = std::fopen(rutaTemporal.c_str(), "wb");
+        if (!archivo) return false;
+        bool escrito = std::fwrite(&cab, sizeof(cab), 1, archivo) == 1;
+        if (!registros.empty()) {
+            escrito = escrito && std::fwrite(registros.data(), sizeof(Registro), registros.size(), archivo) == registros.size();
+        }
+        if (!episodios.empty()) {
+            escrito = escrito && std::fwrite(episodios.data(), sizeof(RegistroEpisodio), episodios.size(), archivo) == episodios.size();
+        }
+        escrito = escrito && std::fwrite(cadenas.data(), 1, cadenas.size(), archivo) == cadenas.size();
+        escrito = sincronizarArchivo(archivo) && escrito;
+        std::fclose(archivo);
+        
+        std::error_code ec;
+        if (escrito) std::filesystem::rename(rutaTemporal, ruta, ec);
+        if (!escrito || ec) {
+            std::filesystem::remove(rutaTemporal, ec);
+            return false;
+        }
+        return true;
+    }
+    
+    // Construye los videos directamente desde el archivo mapeado. Devuelve
+    // false (sin tocar 'salida') si falta o está dañada. 'vigente' indica si
+    // se escribió con la época epocaHistorial del historial de texto.
+    static bool cargar(const std::string& ruta, uint64_t epocaHistorial,
+                       std::vector<std::shared_ptr<Video>>& salida, bool& vigente) {
+        ArchivoMapeado mapeo(ruta);
+        if (!mapeo.valido()) return false;
+        std::string_view datos = mapeo.contenido();
+        
+        Cabecera cab;
+        if (datos.size() < sizeof(cab)) return false;
+        std::memcpy(&cab, datos.data(), sizeof(cab));
+        if (std::memcmp(cab.magia, magia(), sizeof(cab.magia)) != 0 ||
+            cab.version == 0 || cab.version > VERSION ||
+            (cab.version == 1 && cab.numEpisodios != 0)) {
+            return false;
+        }
+        
+        uint64_t tamRegistros = static_cast<uint64_t>(cab.numRegistros) * sizeof(Registro);
+        uint64_t tamEpisodios = static_cast<uint64_t>(cab.numEpisodios) * sizeof(RegistroEpisodio);
+        if (datos.size() != sizeof(cab) + tamRegistros + tamEpisodios + cab.tamCadenas) return false;
+        const char* inicioRegistros = datos.data() + sizeof(cab);
+        const char* inicioEpisodios = inicioRegistros + tamRegistros;
+        std::string_view cadenas(inicioEpisodios + tamEpisodios, cab.tamCadenas);
+        uint32_t suma = sumaVerificacion(inicioRegistros, tamRegistros) ^
+                        sumaVerificacion(cadenas.data(), cadenas.size());
+        if (cab.numEpisodios > 0) suma ^= sumaVerificacion(inicioEpisodios, tamEpisodios);
+        if (suma != cab.suma) return false;
+        
+        auto cadena = [&](uint32_t desp, uint32_t longitud) {
+            if (static_cast<uint64_t>(desp) + longitud > cadenas.size()) {
+                throw std::out_of_range("instantanea");
+            }
+            return std::string(cadenas.substr(desp, longitud));
+        };
+        
+        std::vector<std::shared_ptr<Video>> videos;
+        videos.reserve(cab.numRegistros);
+        try {
+            for (uint32_t i = 0; i < cab.numRegistros; i++) {
+                Registro r;
+                std::memcpy(&r, inicioRegistros + i * sizeof(Registro), sizeof(r));
+                if (r.tipo == TIPO_PELICULA) {
+                    videos.push_back(std::make_shared<Pelicula>(
+                        cadena(r.titulo, r.longTitulo), r.calificacion, r.duracion,
+                        cadena(r.genero, r.longGenero), cadena(r.director, r.longDirector), r.anio));
+                } else {
+                    videos.push_back(std::make_shared<Serie>(
+                        cadena(r.titulo, r.longTitulo), r.calificacion, r.episodiosPorTemporada,
+                        cadena(r.genero, r.longGenero), r.numTemporadas, r.totalEpisodios,
+                        cadena(r.director, r.longDirector)));
+                }
+            }
+            for (uint32_t i = 0; i < cab.numEpisodios; i++) {
+                RegistroEpisodio re;
+                std::memcpy(&re, inicioEpisodios + i * sizeof(RegistroEpisodio), sizeof(re));
+                if (re.registro >= videos.size() || videos[re.registro]->getTipoId() != AlmacenCatalogo::SERIE) {
+                    return false;
+                }
+                static_cast<Serie&>(*videos[re.registro]).agregarEpisodio(
+                    re.temporada, re.numero, re.duracion, cadena(re.ruta, re.longRuta), re.visto != 0);
+            }
+        } catch (const std::out_of_range&) {
+            return false;
+        }
+        
+        salida = std::move(videos);
+        vigente = cab.version == VERSION && cab.epocaHistorial == epocaHistorial;
+        return true;
+    }
+};
+
+// Miniaturas ya reducidas guardadas junto a las portadas, en
+// portadas\miniaturas\<nombre>.rgb, para no decodificar el JPEG completo en
+// cada arranque. Cada archivo guarda la firma (tamaño y fecha) de la portada
+// de la que salió; si la portada cambia, la miniatura se descarta y se rehace.
+class MiniaturasEnDisco {
+private:
+    static constexpr uint32_t VERSION = 1;
+    
+    struct Cabecera {
+        char magia[8];
+        uint32_t version;
+        uint16_t ancho;
+        uint16_t alto;
+        uint64_t firmaPortada;
+        uint32_t profundidad;
+        uint32_t suma;
+    };
+    
+    static const char* magia() { return "NPMINIA"; }
+    
+    static std::string rutaMiniatura(const std::string& rutaPortada) {
+        size_t barra = rutaPortada.find_last_of("\\/");
+        std::string directorio = barra == std::string::npos ? "" : rutaPortada.substr(0, barra + 1);
+        std::string nombre = barra == std::string::npos ? rutaPortada : rutaPortada.substr(barra + 1);
+        size_t punto = nombre.find_last_of('.');
+        if (punto != std::string::npos) nombre.erase(punto);
+        return directorio + "miniaturas\\" + nombre + ".rgb";
+    }
+
+public:
+    // Miniatura guardada para la portada con esa firma, o nullptr
+    static Fl_Image* cargar(const std::string& rutaPortada, uint64_t firmaPortada) {
+        FILE* archivo = std::fopen(rutaMiniatura(rutaPortada).c_str(), "rb");
+        if (!archivo) return nullptr;
+        
+        Cabecera cab;
+        bool valida = std::fread(&cab, sizeof(cab), 1, archivo) == 1 &&
+                      std::memcmp(cab.magia, magia(), sizeof(cab.magia)) == 0 &&
+                      cab.version == VERSION && cab.firmaPortada == firmaPortada &&
+                      cab.ancho > 0 && cab.alto > 0 && cab.profundidad >= 1 && cab.profundidad <= 4;
+        if (!valida) {
+            std::fclose(archivo);
+            return nullptr;
+        }
+        
+        size_t tamano = static_cast<size_t>(cab.ancho) * cab.alto * cab.profundidad;
+        std::unique_ptr<unsigned char[]> pixeles(new unsigned char[tamano]);
+        valida = std::fread(pixeles.get(), 1, tamano, archivo) == tamano &&
+                 std::fgetc(archivo) == EOF &&
+                 sumaVerificacion(reinterpret_cast<const char*>(pixeles.get()), tamano) == cab.suma;
+        std::fclose(archivo);
+        if (!valida) return nullptr;
+        
+        Fl_RGB_Image* imagen = new Fl_RGB_Image(pixeles.release(), cab.ancho, cab.alto, cab.profundidad);
+        imagen->alloc_array = 1;
+        return imagen;
+    }
+    
+    // Guarda la miniatura; un fallo sólo significa que se volverá a decodificar
+    static bool guardar(const std::string& rutaPortada, uint64_t firmaPortada, Fl_Image* miniatura) {
+        Fl_RGB_Image* rgb = dynamic_cast<Fl_RGB_Image*>(miniatura);
+        if (!rgb || !rgb->array || rgb->w() > UINT16_MAX || rgb->h() > UINT16_MAX) return false;
+        
+        std::string ruta = rutaMiniatura(rutaPortada);
+        std::error_code ec;
+        std::filesystem::create_directories(ruta.substr(0, ruta.find_last_of("\\/") + 1), ec);
+        
+        size_t tamano = static_cast<size_t>(rgb->w()) * rgb->h() * rgb->d();
+        Cabecera cab = {};
+        std::memcpy(cab.magia, magia(), sizeof(cab.magia));
+        cab.version = VERSION;
+        cab.ancho = static_cast<uint16_t>(rgb->w());
+        cab.alto = static_cast<uint16_t>(rgb->h());
+        cab.firmaPortada = firmaPortada;
+        cab.profundidad = static_cast<uint32_t>(rgb->d());
+        cab.suma = sumaVerificacion(reinterpret_cast<const char*>(rgb->array), tamano);
+        
+        std::string rutaTemporal = ruta + ".tmp";
+        FILE* archivo = std::fopen(rutaTemporal.c_str(), "wb");
+        if (!archivo) return false;
+        bool escrito = std::fwrite(&cab, sizeof(cab), 1, archivo) == 1 &&
+                       std::fwrite(rgb->array, 1, tamano, archivo) == tamano;
+        escrito = std::fclose(archivo) == 0 && escrito;
+        if (!escrito) {
+            std::remove(rutaTemporal.c_str());
+            return false;
+        }
+        
+        std::filesystem::rename(rutaTemporal, ruta, ec);
+        if (ec) {
+            std::remove(rutaTemporal.c_str());
+            return false;
+        }
+        return true;
     }
+};
 
+// Caché de miniaturas de portadas. Las portadas se decodifican y reducen al
+// tamaño de PortadaBox en hilos de fondo; el resultado vuelve al hilo de FLTK
+// con Fl::awake y se guarda en una LRU limitada por bytes. Salvo la
+// decodificación, todo se usa desde el hilo de la interfaz.
+class CachePortadas {
 public:
-    HistorialManager(const std::string& ruta = "C:\\Users\\DiegoB\\Desktop\\Netflix_piraton\\historialDatos.txt") 
-        : rutaHistorial(ruta) {}
+    static constexpr int ANCHO = 120;
+    static constexpr int ALTO = 160;
+
+private:
+    struct Entrada {
+        std::string ruta;
+        std::shared_ptr<Fl_Image> imagen;
+        size_t bytes;
+    };
     
-    // Cargar calificaciones desde el archivo
-    void cargarHistorial(std::vector<std::shared_ptr<Video>>& catalogo) {
-        std::ifstream archivo(rutaHistorial);
-        if (!archivo.is_open()) {
-            // Si no existe el archivo, lo creamos con datos iniciales
-            crearArchivoInicial();
-            return;
+    struct Resultado {
+        std::string ruta;
+        Fl_Image* imagen;   // nullptr si no se pudo decodificar
+    };
+    
+    // Solicitudes sin atender que se conservan; al desplazarse rápido las
+    // más viejas ya no están en pantalla y se descartan
+    static constexpr size_t MAX_PENDIENTES = 64;
+    
+    std::list<Entrada> lru;     // la más reciente al principio
+    std::unordered_map<std::string, std::list<Entrada>::iterator> entradas;
+    std::unordered_set<std::string> fallidas;
+    size_t bytesUsados;
+    size_t presupuesto;
+    std::function<void(const std::string&)> alCargar;
+    
+    std::mutex mutex;                       // protege lo compartido con los hilos
+    std::deque<std::string> pendientes;     // se atiende primero la última
+    std::unordered_set<std::string> enVuelo;
+    std::vector<Resultado> terminados;
+    bool cerrando;
+    
+    PoolHilos decodificadores;  // último miembro: se destruye primero
+    
+    void decodificarSiguiente() {
+        std::string ruta;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cerrando || pendientes.empty()) return;
+            ruta = std::move(pendientes.back());
+            pendientes.pop_back();
         }
         
-        std::string linea;
-        while (std::getline(archivo, linea)) {
-            if (linea.empty() || linea[0] == '#') continue;
-            
-            std::vector<std::string> partes = dividirCadena(linea, '|');
-            if (partes.size() >= 3 && partes[0] == "CALIFICACION") {
-                std::string titulo = partes[1];
-                double calificacion = std::stod(partes[2]);
-                
-                // Buscar el video en el catálogo y actualizar su calificación
-                for (auto& video : catalogo) {
-                    if (video && video->getTitulo() == titulo) {
-                        video->setCalificacion(calificacion);
-                        break;
-                    }
-                }
+        Fl_Image* miniatura = decodificar(ruta);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cerrando) {
+                delete miniatura;
+                return;
             }
+            terminados.push_back({ruta, miniatura});
         }
-        archivo.close();
-    }
-    
-    // Guardar nueva calificación en el archivo
-    void guardarCalificacion(const std::string& titulo, double nuevaCalificacion) {
-        std::ofstream archivo(rutaHistorial, std::ios::app);
-        if (archivo.is_open()) {
-            archivo << "CALIFICACION|" << titulo << "|" << nuevaCalificacion 
-                   << "|" << obtenerFechaHora() << std::endl;
-            archivo.close();
-        }
+        Fl::awake(entregar, this);
     }
     
-    // Actualizar calificación existente en el archivo (reescribir todo el archivo)
-    void actualizarHistorialCompleto(const std::vector<std::shared_ptr<Video>>& catalogo) {
-        std::ofstream archivo(rutaHistorial);
-        if (archivo.is_open()) {
-            archivo << "# Historial de calificaciones - Netflix Piratón\n";
-            archivo << "# Formato: CALIFICACION|Título del Video|Nueva Calificación|Fecha y Hora\n";
-            archivo << "# Este archivo se actualiza automáticamente cuando calificas videos\n\n";
-            archivo << "# Calificaciones actualizadas - " << obtenerFechaHora() << "\n";
-            
-            for (const auto& video : catalogo) {
-                if (video) {
-                    archivo << "CALIFICACION|" << video->getTitulo() << "|" 
-                           << video->getCalificacion() << std::endl;
-                }
-            }
-            archivo.close();
+public:
+    // Usa la miniatura guardada en disco si sigue al día; si no, decodifica
+    // la portada completa y deja la miniatura escrita para la próxima vez
+    static Fl_Image* decodificar(const std::string& ruta) {
+        uint64_t firma = firmaArchivo(ruta);
+        if (firma == 0) return nullptr;
+        if (Fl_Image* guardada = MiniaturasEnDisco::cargar(ruta, firma)) return guardada;
+        
+        std::string extension = std::filesystem::path(ruta).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        
+        std::unique_ptr<Fl_Image> original;
+        if (extension == ".png") {
+            original.reset(new Fl_PNG_Image(ruta.c_str()));
+        } else {
+            original.reset(new Fl_JPEG_Image(ruta.c_str()));
         }
+        if (original->w() <= 0 || original->h() <= 0 || original->d() == 0) return nullptr;
+        
+        // Se reduce conservando la proporción hasta que quepa en la caja
+        double escala = std::min(1.0, std::min(static_cast<double>(ANCHO) / original->w(),
+                                               static_cast<double>(ALTO) / original->h()));
+        int w = std::max(1, static_cast<int>(std::lround(original->w() * escala)));
+        int h = std::max(1, static_cast<int>(std::lround(original->h() * escala)));
+        Fl_Image* miniatura = original->copy(w, h);
+        if (miniatura) MiniaturasEnDisco::guardar(ruta, firma, miniatura);
+        return miniatura;
     }
 
 private:
-    std::vector<std::string> dividirCadena(const std::string& cadena, char separador) {
-        std::vector<std::string> resultado;
-        std::stringstream ss(cadena);
-        std::string item;
+    // Se ejecuta en el hilo de FLTK
+    static void entregar(void* datos) {
+        CachePortadas* cache = static_cast<CachePortadas*>(datos);
+        std::vector<Resultado> listos;
+        {
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            listos.swap(cache->terminados);
+            for (const auto& resultado : listos) cache->enVuelo.erase(resultado.ruta);
+        }
         
-        while (std::getline(ss, item, separador)) {
-            item.erase(0, item.find_first_not_of(" \t"));
-            item.erase(item.find_last_not_of(" \t") + 1);
-            resultado.push_back(item);
+        for (auto& resultado : listos) {
+            if (resultado.imagen) {
+                cache->insertar(resultado.ruta, std::shared_ptr<Fl_Image>(resultado.imagen));
+            } else {
+                cache->fallidas.insert(resultado.ruta);
+            }
+            if (cache->alCargar) cache->alCargar(resultado.ruta);
         }
-        return resultado;
     }
     
-    void crearArchivoInicial() {
-        std::ofstream archivo(rutaHistorial);
-        if (archivo.is_open()) {
-            archivo << "# Historial de calificaciones - Netflix Piratón\n";
-            archivo << "# Formato: CALIFICACION|Título del Video|Nueva Calificación|Fecha y Hora\n";
-            archivo << "# Este archivo se actualiza automáticamente cuando calificas videos\n\n";
-            archivo << "# Datos iniciales del catálogo (calificaciones base)\n";
-            
-            // Calificaciones iniciales
-            archivo << "CALIFICACION|La princesa Mononoke|8.4\n";
-            archivo << "CALIFICACION|El viaje de Chihiro|8.6\n";
-            archivo << "CALIFICACION|Look Back|8.1\n";
-            archivo << "CALIFICACION|Star Wars Episodio I La amenaza fantasma|6.5\n";
-            archivo << "CALIFICACION|Star Wars Episodio II El ataque de los clones|6.5\n";
-            archivo << "CALIFICACION|Star Wars Episodio III La venganza de los Sith|7.5\n";
-            archivo << "CALIFICACION|Star Wars Episodio IV Una nueva esperanza|8.6\n";
-            archivo << "CALIFICACION|Star Wars Episodio V El imperio contraataca|8.7\n";
-            archivo << "CALIFICACION|Star Wars Episodio VI El retorno del Jedi|8.3\n";
-            archivo << "CALIFICACION|Jujutsu Kaisen|8.7\n";
-            archivo << "CALIFICACION|Pokemon|7.5\n";
-            archivo << "CALIFICACION|Violet Evergarden|8.8\n";
-            archivo << "CALIFICACION|Kimetsu no Yaiba|8.7\n";
-            archivo << "CALIFICACION|Attack on Titan|9.0\n";
-            archivo << "CALIFICACION|Blue Lock|8.3\n";
-            archivo << "CALIFICACION|Star Wars The Clone Wars|8.4\n";
-            archivo << "CALIFICACION|Ann|7.9\n";
-            archivo << "CALIFICACION|Nadie nos va a extrañar|8.1\n";
-            archivo << "CALIFICACION|Si la vida te da mandarinas|7.8\n";
-            archivo << "CALIFICACION|Goblin|8.9\n";
-            archivo << "CALIFICACION|Alien Stage|8.5\n";
-            
-            archivo.close();
+    void insertar(const std::string& ruta, std::shared_ptr<Fl_Image> imagen) {
+        size_t bytes = static_cast<size_t>(imagen->w()) * imagen->h() * std::max(1, imagen->d());
+        auto it = entradas.find(ruta);
+        if (it != entradas.end()) {
+            bytesUsados -= it->second->bytes;
+            lru.erase(it->second);
         }
+        lru.push_front({ruta, std::move(imagen), bytes});
+        entradas[ruta] = lru.begin();
+        bytesUsados += bytes;
+        recortar();
     }
-};
-
-// Clase derivada Película
-class Pelicula : public Video {
-private:
-    int duracion;
-    
-public:
-    Pelicula(const std::string& t, double cal, int d, const std::string& g, 
-             const std::string& dir, int a)
-        : Video(t, cal, g, dir, a), duracion(d) {}
-    
-    std::string getTipo() const override { return "Pelicula"; }
     
-    std::string getInfo() const override {
-        std::ostringstream oss;
-        oss << "Película: " << titulo << " | Género: " << genero 
-            << " | Duración: " << duracion << " min | Director: " << director
-            << " | Año: " << anio << " | Calificación: " << std::fixed << std::setprecision(1) << calificacion;
-        return oss.str();
+    // Las imágenes expulsadas que sigan en pantalla viven hasta que su
+    // PortadaBox suelte el shared_ptr
+    void recortar() {
+        while (bytesUsados > presupuesto && lru.size() > 1) {
+            bytesUsados -= lru.back().bytes;
+            entradas.erase(lru.back().ruta);
+            lru.pop_back();
+        }
     }
+
+public:
+    explicit CachePortadas(size_t presupuestoBytes = 32u << 20, size_t numHilos = 2)
+        : bytesUsados(0), presupuesto(presupuestoBytes), cerrando(false),
+          decodificadores(std::max<size_t>(1, numHilos)) {}
     
-    std::string getRutaVideo() const override {
-        std::string nombreArchivo = tituloANombreArchivo(titulo);
-        return basePath + "videos\\peliculas\\" + nombreArchivo + ".mp4";
+    ~CachePortadas() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cerrando = true;
+        pendientes.clear();
+        for (auto& resultado : terminados) delete resultado.imagen;
+        terminados.clear();
     }
     
-    int getDuracion() const { return duracion; }
-};
-
-// Clase derivada Serie
-class Serie : public Video {
-private:
-    int episodiosPorTemporada;
-    int numTemporadas;
-    int totalEpisodios;
+    CachePortadas(const CachePortadas&) = delete;
+    CachePortadas& operator=(const CachePortadas&) = delete;
     
-public:
-    Serie(const std::string& t, double cal, int ept, const std::string& g, 
-          int nt, int te, const std::string& dir)
-        : Video(t, cal, g, dir, 0), episodiosPorTemporada(ept), 
-          numTemporadas(nt), totalEpisodios(te) {}
+    void setPresupuesto(size_t bytes) {
+        presupuesto = bytes;
+        recortar();
+    }
     
-    std::string getTipo() const override { return "Serie"; }
+    size_t getPresupuesto() const { return presupuesto; }
+    size_t getBytesUsados() const { return bytesUsados; }
     
-    std::string getInfo() const override {
-        std::ostringstream oss;
-        oss << "Serie: " << titulo << " | Género: " << genero 
-            << " | Temporadas: " << numTemporadas << " | Episodios: " << totalEpisodios
-            << " | Director: " << director << " | Calificación: " << std::fixed << std::setprecision(1) << calificacion;
-        return oss.str();
+    // Se llama con la ruta de cada portada que termina de decodificarse
+    void setAlCargar(std::function<void(const std::string&)> funcion) {
+        alCargar = std::move(funcion);
     }
     
-    std::string getRutaVideo() const override {
-        std::string nombreArchivo = tituloANombreArchivo(titulo);
-        return basePath + "videos\\series\\" + nombreArchivo + "_s1e1.mp4";
+    // Miniatura ya decodificada o nullptr; un acierto la marca como reciente
+    std::shared_ptr<Fl_Image> buscar(const std::string& ruta) {
+        auto it = entradas.find(ruta);
+        if (it == entradas.end()) return nullptr;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->imagen;
     }
     
-    int getEpisodiosPorTemporada() const { return episodiosPorTemporada; }
-    int getNumTemporadas() const { return numTemporadas; }
-    int getTotalEpisodios() const { return totalEpisodios; }
+    bool fallo(const std::string& ruta) const { return fallidas.count(ruta) > 0; }
     
-    std::string getEpisodiosInfo() const {
-        std::ostringstream oss;
-        int epNum = 1;
-        for (int temp = 1; temp <= numTemporadas; temp++) {
-            int epsEstaTemporada = std::min(episodiosPorTemporada, totalEpisodios - (epNum - 1));
-            for (int ep = 1; ep <= epsEstaTemporada; ep++, epNum++) {
-                oss << "T" << temp << "E" << ep << ": Episodio " << epNum << "\n";
+    // Descarta lo que se sabía de la portada para que se vuelva a decodificar
+    void olvidar(const std::string& ruta) {
+        fallidas.erase(ruta);
+        auto it = entradas.find(ruta);
+        if (it == entradas.end()) return;
+        bytesUsados -= it->second->bytes;
+        lru.erase(it->second);
+        entradas.erase(it);
+    }
+    
+    // Pide la miniatura en segundo plano. Si ya estaba pedida pasa al
+    // frente de la cola, que se atiende de la más nueva a la más vieja.
+    void solicitar(const std::string& ruta) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cerrando) return;
+            if (!enVuelo.insert(ruta).second) {
+                auto it = std::find(pendientes.begin(), pendientes.end(), ruta);
+                if (it != pendientes.end()) {
+                    pendientes.erase(it);
+                    pendientes.push_back(ruta);
+                }
+                return;
+            }
+            pendientes.push_back(ruta);
+            if (pendientes.size() > MAX_PENDIENTES) {
+                enVuelo.erase(pendientes.front());
+                pendientes.pop_front();
             }
         }
-        return oss.str();
+        decodificadores.encolar([this] { decodificarSiguiente(); });
+    }
+    
+    static CachePortadas& global() {
+        static CachePortadas cache;
+        return cache;
     }
 };
 
@@ -340,35 +3593,97 @@ public:
 class PortadaBox : public Fl_Box {
 private:
     std::shared_ptr<Video> video;
-    Fl_Image* imagen;
+    std::shared_ptr<Fl_Image> imagen;
+    std::string rutaPortada;
     CatalogoApp* app;
+    
+    void mostrarImagen(std::shared_ptr<Fl_Image> miniatura) {
+        imagen = std::move(miniatura);
+        image(imagen.get());
+        label(nullptr);
+    }
+    
+    void mostrarSinImagen() {
+        label("Sin\nImagen");
+        align(FL_ALIGN_CENTER | FL_ALIGN_INSIDE);
+    }
+    
+    // La portada sale de la caché de miniaturas; si aún no está se muestra
+    // un aviso y se pide en segundo plano
+    void cargarPortada() {
+        imagen.reset();
+        image(static_cast<Fl_Image*>(nullptr));
+        label(nullptr);
+        rutaPortada = video ? video->getRutaPortadaODefault() : std::string();
+        
+        CachePortadas& cache = CachePortadas::global();
+        if (!video) {
+            // widget libre, oculto por el carrusel
+        } else if (rutaPortada.empty() || cache.fallo(rutaPortada)) {
+            mostrarSinImagen();
+        } else if (auto miniatura = cache.buscar(rutaPortada)) {
+            mostrarImagen(std::move(miniatura));
+        } else {
+            label("Cargando...");
+            align(FL_ALIGN_CENTER | FL_ALIGN_INSIDE);
+            cache.solicitar(rutaPortada);
+        }
+        redraw();
+    }
 
 public:
     PortadaBox(int x, int y, std::shared_ptr<Video> v, CatalogoApp* aplicacion) 
-        : Fl_Box(x, y, 120, 160), video(v), imagen(nullptr), app(aplicacion) {
+        : Fl_Box(x, y, CachePortadas::ANCHO, CachePortadas::ALTO), app(aplicacion) {
         box(FL_BORDER_BOX);
         color(FL_BLACK);
         labelcolor(FL_WHITE);
-        
-        std::string rutaPortada = video->getRutaPortadaODefault();
-        if (!rutaPortada.empty()) {
-            imagen = Fl_Shared_Image::get(rutaPortada.c_str());
-            if (imagen) {
-                image(imagen);
-            }
-        }
-        
-        if (!imagen) {
-            label("Sin\nImagen");
-            align(FL_ALIGN_CENTER | FL_ALIGN_INSIDE);
+        setVideo(std::move(v));
+    }
+    
+    std::shared_ptr<Video> getVideo() const { return video; }
+    
+    // Reutiliza el widget para otro título
+    void setVideo(std::shared_ptr<Video> v) {
+        if (v == video) return;
+        video = std::move(v);
+        cargarPortada();
+        actualizarDatos();
+    }
+    
+    // El tooltip muestra título y calificación; se rehace cuando cambian
+    void actualizarDatos() {
+        if (!video) {
+            tooltip(nullptr);
+            return;
         }
+        std::ostringstream oss;
+        oss << video->getTitulo() << " (" << std::fixed << std::setprecision(1) 
+            << video->getCalificacion() << ")";
+        copy_tooltip(oss.str().c_str());
     }
     
-    ~PortadaBox() {
-        if (imagen) imagen->release();
+    // Vuelve a mirar la portada tras un cambio en el directorio de portadas;
+    // no hace nada si la ruta y la miniatura siguen siendo las mismas
+    void refrescarPortada() {
+        if (!video) return;
+        CachePortadas& cache = CachePortadas::global();
+        if (video->getRutaPortadaODefault() == rutaPortada &&
+            (cache.fallo(rutaPortada) || (imagen && cache.buscar(rutaPortada) == imagen))) {
+            return;
+        }
+        cargarPortada();
     }
     
-    std::shared_ptr<Video> getVideo() const { return video; }
+    // Aviso de que terminó de decodificarse la portada en ruta
+    void portadaCargada(const std::string& ruta) {
+        if (!video || imagen || ruta != rutaPortada) return;
+        if (auto miniatura = CachePortadas::global().buscar(ruta)) {
+            mostrarImagen(std::move(miniatura));
+        } else {
+            mostrarSinImagen();
+        }
+        redraw();
+    }
     
     int handle(int event) override {
         switch(event) {
@@ -394,7 +3709,7 @@ private:
     void reproducirVideo() {
         if (!video) return;
         
-        if (video->getTipo() == "Pelicula") {
+        if (video->getTipoId() == AlmacenCatalogo::PELICULA) {
             std::string rutaVideo = video->getRutaVideo();
             std::string comando = "start \"\" \"" + rutaVideo + "\"";
             int resultado = system(comando.c_str());
@@ -405,12 +3720,153 @@ private:
                 fl_alert("No se pudo reproducir la película.\nVerifica que el archivo existe en: %s", rutaVideo.c_str());
             }
         } 
-        else if (video->getTipo() == "Serie") {
+        else if (video->getTipoId() == AlmacenCatalogo::SERIE) {
             fl_message("Serie: %s\nUsa la opción 3 del menú para seleccionar episodios.", video->getTitulo().c_str());
         }
     }
 };
 
+// Tira de portadas virtualizada. Sólo existen los PortadaBox que caben en la
+// ventana más un pequeño margen de precarga; al desplazarse se reciclan para
+// los títulos que van entrando. Un espaciador vacío le da al Fl_Scroll el
+// ancho del catálogo completo para que la barra tenga el rango correcto.
+class CarruselPortadas : public Fl_Scroll {
+private:
+    static constexpr int ANCHO_PORTADA = 120;
+    static constexpr int PASO = 130;        // portada + separación
+    static constexpr int MARGEN = 5;
+    static constexpr int PRECARGA = 2;      // portadas extra a cada lado
+    
+    CatalogoApp* app;
+    Fl_Box* espaciador;
+    std::vector<std::shared_ptr<Video>> videos;
+    std::vector<PortadaBox*> reciclables;
+
+public:
+    CarruselPortadas(int x, int y, int w, int h, CatalogoApp* aplicacion)
+        : Fl_Scroll(x, y, w, h), app(aplicacion) {
+        type(Fl_Scroll::HORIZONTAL);
+        espaciador = new Fl_Box(x + MARGEN, y + MARGEN, 1, 160);
+        espaciador->box(FL_NO_BOX);
+        end();
+        hscrollbar.callback(alDesplazar, this);
+        
+        CachePortadas::global().setAlCargar([this](const std::string& ruta) {
+            for (auto* portada : reciclables) {
+                if (portada->visible()) portada->portadaCargada(ruta);
+            }
+        });
+        
+        // Portadas nuevas, borradas o reemplazadas en disco
+        Video::indicePortadas().setAlCambiar([this](const std::vector<std::string>& nombres) {
+            CachePortadas& cache = CachePortadas::global();
+            for (const auto& nombre : nombres) {
+                cache.olvidar(Video::indicePortadas().getDirectorio() + nombre);
+            }
+            for (auto* portada : reciclables) {
+                if (portada->visible()) portada->refrescarPortada();
+            }
+        });
+    }
+    
+    ~CarruselPortadas() {
+        CachePortadas::global().setAlCargar(nullptr);
+        Video::indicePortadas().setAlCambiar(nullptr);
+    }
+    
+    // Cambia la lista de títulos. Si es la misma no toca nada; si no, los
+    // widgets cuyos títulos siguen en pantalla sólo se mueven de sitio.
+    void establecerVideos(const std::vector<std::shared_ptr<Video>>& nuevos) {
+        std::vector<std::shared_ptr<Video>> lista;
+        lista.reserve(nuevos.size());
+        for (const auto& video : nuevos) {
+            if (video) lista.push_back(video);
+        }
+        if (lista == videos) return;
+        videos.swap(lista);
+        
+        int ancho = std::max(1, static_cast<int>(videos.size()) * PASO - (PASO - ANCHO_PORTADA));
+        int maxPosicion = std::max(0, ancho + 2 * MARGEN - w());
+        if (xposition() > maxPosicion) {
+            scroll_to(maxPosicion, yposition());
+        }
+        espaciador->resize(x() + MARGEN - xposition(), y() + MARGEN, ancho, 160);
+        
+        materializar();
+        redraw();
+    }
+    
+    // Actualiza en su sitio la portada de un título que cambió, sin tocar
+    // el resto de la tira
+    void refrescarVideo(const std::shared_ptr<Video>& video) {
+        for (auto* portada : reciclables) {
+            if (portada->visible() && portada->getVideo() == video) portada->actualizarDatos();
+        }
+    }
+    
+    void resize(int X, int Y, int W, int H) override {
+        Fl_Scroll::resize(X, Y, W, H);
+        materializar();
+    }
+
+private:
+    // Asigna los títulos visibles a los widgets reciclables. Un widget que ya
+    // muestra uno de esos títulos se queda con él y sólo se mueve; los libres
+    // toman los títulos que entran, así que al desplazarse o reordenar sólo
+    // se cargan las portadas nuevas en pantalla.
+    void materializar() {
+        int total = static_cast<int>(videos.size());
+        int primero = std::max(0, (xposition() - MARGEN) / PASO - PRECARGA);
+        int ultimo = std::min(total, (xposition() + w()) / PASO + 1 + PRECARGA);
+        
+        size_t necesarias = static_cast<size_t>((w() + MARGEN) / PASO + 2 + 2 * PRECARGA);
+        while (reciclables.size() < necesarias) {
+            PortadaBox* portada = new PortadaBox(x(), y() + MARGEN, nullptr, app);
+            portada->hide();
+            add(portada);
+            reciclables.push_back(portada);
+        }
+        
+        size_t n = reciclables.size();
+        std::vector<bool> usada(n, false);
+        std::vector<PortadaBox*> asignadas(std::max(0, ultimo - primero), nullptr);
+        for (int i = primero; i < ultimo; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                if (!usada[j] && reciclables[j]->getVideo() == videos[i]) {
+                    usada[j] = true;
+                    asignadas[i - primero] = reciclables[j];
+                    break;
+                }
+            }
+        }
+        
+        size_t libre = 0;
+        for (int i = primero; i < ultimo; ++i) {
+            PortadaBox* portada = asignadas[i - primero];
+            if (!portada) {
+                while (usada[libre]) ++libre;
+                usada[libre] = true;
+                portada = reciclables[libre];
+                portada->setVideo(videos[i]);
+            }
+            portada->position(x() + MARGEN + i * PASO - xposition(), y() + MARGEN);
+            if (!portada->visible()) portada->show();
+        }
+        
+        for (size_t j = 0; j < n; ++j) {
+            if (usada[j]) continue;
+            if (reciclables[j]->visible()) reciclables[j]->hide();
+            reciclables[j]->setVideo(nullptr);
+        }
+    }
+    
+    static void alDesplazar(Fl_Widget* barra, void* datos) {
+        CarruselPortadas* carrusel = static_cast<CarruselPortadas*>(datos);
+        carrusel->scroll_to(static_cast<Fl_Scrollbar*>(barra)->value(), carrusel->yposition());
+        carrusel->materializar();
+    }
+};
+
 // Ventana emergente para selecciones
 class SelectorWindow : public Fl_Window {
 private:
@@ -433,12 +3889,138 @@ public:
         }
         choice->value(0);
         
-        okBtn = new Fl_Button(100, 80, 80, 30, "Aceptar");
+        okBtn = new Fl_Button(100, 80, 80, 30, "Aceptar");
+        okBtn->color(FL_DARK2);
+        okBtn->labelcolor(FL_WHITE);
+        okBtn->callback(okCallback, this);
+        
+        cancelBtn = new Fl_Button(190, 80, 80, 30, "Cancelar");
+        cancelBtn->color(FL_DARK2);
+        cancelBtn->labelcolor(FL_WHITE);
+        cancelBtn->callback(cancelCallback, this);
+        
+        end();
+    }
+    
+    std::string getSeleccion() const { return seleccion; }
+    bool fueCancelado() const { return cancelado; }
+    
+private:
+    static void okCallback(Fl_Widget*, void* data) {
+        SelectorWindow* win = static_cast<SelectorWindow*>(data);
+        if (win->choice->value() >= 0) {
+            win->seleccion = win->choice->text();
+            win->cancelado = false;
+        }
+        win->hide();
+    }
+    
+    static void cancelCallback(Fl_Widget*, void* data) {
+        SelectorWindow* win = static_cast<SelectorWindow*>(data);
+        win->cancelado = true;
+        win->hide();
+    }
+};
+
+// Lista de episodios de una serie que sólo da formato a las filas visibles:
+// la tabla pide cada celda al dibujarse, así que una serie con miles de
+// episodios no crea ninguna cadena de más
+class TablaEpisodios : public Fl_Table_Row {
+private:
+    const Serie& serie;
+
+protected:
+    void draw_cell(TableContext contexto, int fila, int columna, int x, int y, int w, int h) override {
+        switch (contexto) {
+            case CONTEXT_STARTPAGE:
+                fl_font(FL_HELVETICA, 14);
+                return;
+            case CONTEXT_COL_HEADER:
+                fl_push_clip(x, y, w, h);
+                fl_draw_box(FL_THIN_UP_BOX, x, y, w, h, FL_DARK2);
+                fl_color(FL_WHITE);
+                fl_draw("Episodio", x + 4, y, w - 8, h, FL_ALIGN_LEFT);
+                fl_pop_clip();
+                return;
+            case CONTEXT_CELL: {
+                char texto[64];
+                serie.getEpisodio(fila).escribir(texto, sizeof(texto));
+                fl_push_clip(x, y, w, h);
+                fl_color(row_selected(fila) ? FL_SELECTION_COLOR : FL_DARK3);
+                fl_rectf(x, y, w, h);
+                fl_color(FL_WHITE);
+                fl_draw(texto, x + 4, y, w - 8, h, FL_ALIGN_LEFT);
+                fl_pop_clip();
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+public:
+    TablaEpisodios(int x, int y, int w, int h, const Serie& s)
+        : Fl_Table_Row(x, y, w, h), serie(s) {
+        type(SELECT_SINGLE);
+        rows(serie.getCantidadEpisodios());
+        cols(1);
+        col_header(1);
+        col_width(0, w - 20);
+        row_height_all(22);
+        color(FL_DARK3);
+        end();
+    }
+    
+    // Índice de la fila seleccionada, o -1
+    int seleccionada() {
+        for (int fila = 0; fila < rows(); fila++) {
+            if (row_selected(fila)) return fila;
+        }
+        return -1;
+    }
+    
+    void mostrarFila(int fila) {
+        select_all_rows(0);
+        select_row(fila);
+        top_row(fila);
+    }
+};
+
+// Selector de episodio: la tabla virtual de arriba más un salto a temporada
+class SelectorEpisodiosWindow : public Fl_Window {
+private:
+    const Serie& serie;
+    TablaEpisodios* tabla;
+    Fl_Spinner* temporadaSpinner;
+    Fl_Button* okBtn;
+    Fl_Button* cancelBtn;
+    int seleccion;
+    bool cancelado;
+
+public:
+    SelectorEpisodiosWindow(const std::string& titulo, const Serie& s)
+        : Fl_Window(360, 460, titulo.c_str()), serie(s), seleccion(-1), cancelado(true) {
+        color(FL_BLACK);
+        
+        temporadaSpinner = new Fl_Spinner(100, 15, 80, 30, "Temporada:");
+        temporadaSpinner->minimum(1);
+        temporadaSpinner->maximum(std::max(1, serie.getNumTemporadas()));
+        temporadaSpinner->value(1);
+        temporadaSpinner->color(FL_DARK3);
+        temporadaSpinner->textcolor(FL_WHITE);
+        temporadaSpinner->labelcolor(FL_WHITE);
+        temporadaSpinner->callback(temporadaCallback, this);
+        
+        tabla = new TablaEpisodios(20, 55, 320, 340, serie);
+        tabla->callback(tablaCallback, this);
+        if (serie.getCantidadEpisodios() > 0) tabla->select_row(0);
+        
+        okBtn = new Fl_Button(170, 410, 80, 30, "Aceptar");
         okBtn->color(FL_DARK2);
         okBtn->labelcolor(FL_WHITE);
         okBtn->callback(okCallback, this);
         
-        cancelBtn = new Fl_Button(190, 80, 80, 30, "Cancelar");
+        cancelBtn = new Fl_Button(260, 410, 80, 30, "Cancelar");
         cancelBtn->color(FL_DARK2);
         cancelBtn->labelcolor(FL_WHITE);
         cancelBtn->callback(cancelCallback, this);
@@ -446,31 +4028,141 @@ public:
         end();
     }
     
-    std::string getSeleccion() const { return seleccion; }
+    // Índice (desde 0) del episodio elegido
+    int getSeleccion() const { return seleccion; }
     bool fueCancelado() const { return cancelado; }
     
 private:
-    static void okCallback(Fl_Widget*, void* data) {
-        SelectorWindow* win = static_cast<SelectorWindow*>(data);
-        if (win->choice->value() >= 0) {
-            win->seleccion = win->choice->text();
-            win->cancelado = false;
+    void aceptar() {
+        seleccion = tabla->seleccionada();
+        cancelado = seleccion < 0;
+        hide();
+    }
+    
+    static void temporadaCallback(Fl_Widget*, void* data) {
+        SelectorEpisodiosWindow* win = static_cast<SelectorEpisodiosWindow*>(data);
+        int temporada = static_cast<int>(win->temporadaSpinner->value());
+        int fila = win->serie.primerEpisodioDe(temporada);
+        if (fila < win->serie.getCantidadEpisodios()) win->tabla->mostrarFila(fila);
+    }
+    
+    // Doble clic en un episodio equivale a aceptar
+    static void tablaCallback(Fl_Widget*, void* data) {
+        SelectorEpisodiosWindow* win = static_cast<SelectorEpisodiosWindow*>(data);
+        if (win->tabla->callback_context() == Fl_Table::CONTEXT_CELL && Fl::event_clicks()) {
+            win->aceptar();
         }
-        win->hide();
+    }
+    
+    static void okCallback(Fl_Widget*, void* data) {
+        static_cast<SelectorEpisodiosWindow*>(data)->aceptar();
     }
     
     static void cancelCallback(Fl_Widget*, void* data) {
-        SelectorWindow* win = static_cast<SelectorWindow*>(data);
+        SelectorEpisodiosWindow* win = static_cast<SelectorEpisodiosWindow*>(data);
         win->cancelado = true;
         win->hide();
     }
 };
 
+// Vista de resultados virtual. Sólo guarda cuántas filas hay y cómo dar
+// formato a cada una; al dibujar se formatean las visibles, así que un
+// listado de cualquier tamaño abre al instante y sin crecer en memoria.
+// Arriba van las líneas fijas del encabezado y abajo las del pie.
+class ListaResultados : public Fl_Table {
+public:
+    using Formateador = std::function<void(size_t, std::string&)>;
+
+private:
+    static constexpr int ANCHO_LINEA = 1600;
+    
+    std::vector<std::string> encabezado;
+    std::vector<std::string> pie;
+    size_t numElementos;
+    Formateador formatear;
+    std::string linea;
+    
+    static std::vector<std::string> dividirLineas(const std::string& texto) {
+        std::vector<std::string> lineas;
+        size_t inicio = 0;
+        while (inicio < texto.size()) {
+            size_t fin = texto.find('\n', inicio);
+            if (fin == std::string::npos) fin = texto.size();
+            lineas.emplace_back(texto, inicio, fin - inicio);
+            inicio = fin + 1;
+        }
+        return lineas;
+    }
+
+protected:
+    void draw_cell(TableContext contexto, int fila, int columna, int x, int y, int w, int h) override {
+        switch (contexto) {
+            case CONTEXT_STARTPAGE:
+                fl_font(FL_HELVETICA, 14);
+                return;
+            case CONTEXT_CELL: {
+                size_t i = static_cast<size_t>(fila);
+                const std::string* texto = &linea;
+                if (i < encabezado.size()) {
+                    texto = &encabezado[i];
+                } else if (i - encabezado.size() < numElementos) {
+                    linea.clear();
+                    formatear(i - encabezado.size(), linea);
+                } else {
+                    texto = &pie[i - encabezado.size() - numElementos];
+                }
+                fl_push_clip(x, y, w, h);
+                fl_color(FL_DARK3);
+                fl_rectf(x, y, w, h);
+                fl_color(FL_WHITE);
+                fl_draw(texto->c_str(), x + 4, y, w - 8, h, FL_ALIGN_LEFT);
+                fl_pop_clip();
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+public:
+    ListaResultados(int x, int y, int w, int h)
+        : Fl_Table(x, y, w, h), numElementos(0) {
+        rows(0);
+        cols(1);
+        col_header(0);
+        row_header(0);
+        col_width(0, ANCHO_LINEA);
+        row_height_all(20);
+        color(FL_DARK3);
+        end();
+    }
+    
+    // Reemplaza el contenido: n filas entre encabezado y pie, cada una
+    // escrita por formatear(i, linea) cuando se ve
+    void establecer(const std::string& textoEncabezado, size_t n, Formateador formateador,
+                    const std::string& textoPie = "") {
+        encabezado = dividirLineas(textoEncabezado);
+        pie = dividirLineas(textoPie);
+        numElementos = n;
+        formatear = std::move(formateador);
+        size_t total = encabezado.size() + numElementos + pie.size();
+        rows(static_cast<int>(std::min<size_t>(total, std::numeric_limits<int>::max())));
+        row_height_all(20);
+        top_row(0);
+        redraw();
+    }
+};
+
 // Clase principal de la aplicación
 class CatalogoApp {
 private:
     HistorialManager historial;
     std::vector<std::shared_ptr<Video>> catalogo;
+    std::vector<uint32_t> idsCatalogo;      // ids de fila en el mismo orden que catalogo
+    IndiceTitulos indiceTitulos;
+    mutable std::string claveBusqueda;
+    IndiceBusqueda indiceBusqueda;
+    MotorSimilitud motorSimilitud;
     Fl_Window* window;
     Fl_Choice* menuChoice;
     Fl_Button* ejecutarBtn;
@@ -478,196 +4170,291 @@ private:
     Fl_Spinner* calificacionSpinner;
     Fl_Text_Display* resultadosDisplay;
     Fl_Text_Buffer* textBuffer;
-    Fl_Scroll* scrollPortadas;
-    Fl_Pack* packPortadas;
-    std::vector<PortadaBox*> portadas;
+    ListaResultados* listaResultados;     // ocupa el mismo lugar que resultadosDisplay
+    CarruselPortadas* scrollPortadas;
 
+    std::string rutaInstantanea() const {
+        return historial.getRutaHistorial() + ".cat";
+    }
+    
     void guardarHistorialAlCerrar() {
         historial.actualizarHistorialCompleto(catalogo);
+        InstantaneaCatalogo::guardar(rutaInstantanea(), catalogo, historial.getEpoca());
     }
-
-    void procesarArchivoDatos(const std::string& rutaArchivo) {
-        std::ifstream archivo(rutaArchivo);
-        if (!archivo.is_open()) {
-            fl_alert("No se pudo abrir el archivo: %s", rutaArchivo.c_str());
+    
+    // Arranque rápido desde la instantánea binaria. Si el historial de texto
+    // se reescribió después de guardarla (compactaciones en una sesión que no
+    // terminó con "Salir"), sus calificaciones se ponen al día con él: el
+    // historial más su bitácora siempre tienen todas las calificaciones. Sin
+    // instantánea se reconstruye desde los datos por defecto.
+    void cargarCatalogoInicial() {
+        uint64_t epoca = historial.leerEpoca();
+        std::vector<std::shared_ptr<Video>> videos;
+        bool vigente = false;
+        if (InstantaneaCatalogo::cargar(rutaInstantanea(), epoca, videos, vigente)) {
+            catalogo.reserve(videos.size());
+            indiceTitulos.reserve(videos.size());
+            for (auto& video : videos) agregarAlCatalogo(std::move(video));
+            if (!vigente) historial.aplicarInstantanea(indiceTitulos);
+            historial.reproducirBitacora(indiceTitulos);
             return;
         }
-        
-        std::string linea;
+        cargarDatosPorDefecto();
+        historial.cargarHistorial(indiceTitulos);
+    }
+    
+    // Registra un cambio de calificación en la bitácora durable del historial
+    void registrarCalificacion(const Video& video) {
+        historial.guardarCalificacion(video.getTitulo(), video.getCalificacion());
+        historial.compactarSiNecesario(catalogo);
+    }
+
+    static constexpr int MAX_SUGERENCIAS_IMPORTACION = 20;
+    
+    struct ResumenImportacion {
         int lineasProcesadas = 0;
         int calificacionesActualizadas = 0;
         int videosAgregados = 0;
-        std::string errores;
+        int episodiosAgregados = 0;
+        int titulosPlegados = 0;        // resueltos sin distinguir mayúsculas ni acentos
+        int sugerenciasCalculadas = 0;  // búsquedas aproximadas hechas para mensajes de error
+        std::vector<std::string> errores;
+    };
+    
+    void registrarError(const OperacionDatos& op, const std::string& motivo, ResumenImportacion& res) {
+        res.errores.push_back("Error en linea " + std::to_string(res.lineasProcesadas) +
+                              ": " + std::string(op.linea) + " (" + motivo + ")");
+    }
+    
+    // Aplica al catálogo una línea ya interpretada; siempre en orden de archivo
+    void aplicarOperacion(const OperacionDatos& op, ResumenImportacion& res) {
+        res.lineasProcesadas++;
+        RegistroDatos registro;
+        RegistroDatos::dividir(op.linea, registro);
+        const auto& partes = registro.campos;
         
-        while (std::getline(archivo, linea)) {
-            if (linea.empty() || linea[0] == '#') continue;
-            
-            lineasProcesadas++;
-            std::vector<std::string> partes = dividirCadena(linea, '|');
-            if (partes.empty()) continue;
-            
-            std::string tipo = partes[0];
-            
-            try {
-                if (tipo == "CALIFICACION" && partes.size() >= 3) {
-                    if (actualizarCalificacionExistente(partes[1], std::stod(partes[2]))) {
-                        calificacionesActualizadas++;
-                    }
-                }
-                else if (tipo == "PELICULA" && partes.size() >= 7) {
-                    agregarNuevaPelicula(partes);
-                    videosAgregados++;
-                }
-                else if (tipo == "SERIE" && partes.size() >= 8) {
-                    agregarNuevaSerie(partes);
-                    videosAgregados++;
-                }
-                else if (tipo == "USUARIO_CALIFICACION" && partes.size() >= 4) {
-                    procesarCalificacionUsuario(partes[1], partes[2], std::stoi(partes[3]));
-                }
-                else if (tipo == "GENERO" && partes.size() >= 3) {
-                    actualizarGeneroVideo(partes[1], partes[2]);
+        switch (op.tipo) {
+            case OperacionDatos::CALIFICACION:
+                if (actualizarCalificacionExistente(op, partes[1], res)) {
+                    res.calificacionesActualizadas++;
                 }
+                break;
+            case OperacionDatos::PELICULA:
+                agregarNuevaPelicula(op, registro);
+                res.videosAgregados++;
+                break;
+            case OperacionDatos::SERIE:
+                agregarNuevaSerie(op, registro);
+                res.videosAgregados++;
+                break;
+            case OperacionDatos::EPISODIO:
+                if (agregarEpisodio(op, registro, res)) res.episodiosAgregados++;
+                break;
+            case OperacionDatos::USUARIO_CALIFICACION:
+                procesarCalificacionUsuario(op, partes[1], partes[2], res);
+                break;
+            case OperacionDatos::GENERO:
+                actualizarGeneroVideo(op, partes[1], partes[2], res);
+                break;
+            case OperacionDatos::ERROR:
+                registrarError(op, op.error, res);
+                break;
+            case OperacionDatos::IGNORADA:
+                break;
+        }
+    }
+    
+    void procesarArchivoDatos(const std::string& rutaArchivo) {
+        auto inicioImportacion = std::chrono::steady_clock::now();
+        
+        // Preferimos mapear el archivo; si no se puede, se lee por flujo
+        ArchivoMapeado mapeo(rutaArchivo);
+        std::ifstream archivo;
+        size_t bytesArchivo = 0;
+        ResumenImportacion res;
+        if (mapeo.valido()) {
+            bytesArchivo = mapeo.getTamano();
+            importarEnParalelo(mapeo.contenido(), PoolHilos::compartido(),
+                               [&](const OperacionDatos& op) { aplicarOperacion(op, res); });
+        } else {
+            archivo.open(rutaArchivo, std::ios::binary | std::ios::ate);
+            if (!archivo.is_open()) {
+                fl_alert("No se pudo abrir el archivo: %s", rutaArchivo.c_str());
+                return;
             }
-            catch (const std::exception& e) {
-                errores += "Error en linea " + std::to_string(lineasProcesadas) + 
-                          ": " + linea + " (" + e.what() + ")\n";
+            bytesArchivo = static_cast<size_t>(archivo.tellg());
+            archivo.seekg(0);
+            
+            LectorRegistros lector(archivo);
+            RegistroDatos registro;
+            while (lector.siguiente(registro)) {
+                aplicarOperacion(OperacionDatos::interpretar(registro), res);
             }
         }
         
+        std::chrono::duration<double> duracion = std::chrono::steady_clock::now() - inicioImportacion;
+        double megabytes = bytesArchivo / (1024.0 * 1024.0);
+        
         archivo.close();
         actualizarPortadas();
+        motorSimilitud.preparar();
         
         std::ostringstream resumen;
         resumen << "=== ARCHIVO PROCESADO EXITOSAMENTE ===\n\n";
         resumen << "Archivo: " << rutaArchivo << "\n";
-        resumen << "Lineas procesadas: " << lineasProcesadas << "\n";
-        resumen << "Calificaciones actualizadas: " << calificacionesActualizadas << "\n";
-        resumen << "Videos agregados: " << videosAgregados << "\n";
+        resumen << "Modo de lectura: " << (mapeo.valido() ? "mapeo en memoria" : "flujo (ifstream)") << "\n";
+        resumen << "Tamaño: " << std::fixed << std::setprecision(2) << megabytes << " MB en "
+                << duracion.count() * 1000.0 << " ms";
+        if (duracion.count() > 0) {
+            resumen << " (" << megabytes / duracion.count() << " MB/s)";
+        }
+        resumen << "\n";
+        resumen << "Lineas procesadas: " << res.lineasProcesadas << "\n";
+        resumen << "Calificaciones actualizadas: " << res.calificacionesActualizadas << "\n";
+        if (res.titulosPlegados > 0) {
+            resumen << "  (" << res.titulosPlegados << " sin distinguir mayúsculas ni acentos)\n";
+        }
+        resumen << "Videos agregados: " << res.videosAgregados << "\n";
+        resumen << "Episodios agregados: " << res.episodiosAgregados << "\n";
         resumen << "Total videos en catalogo: " << catalogo.size() << "\n\n";
         
-        if (!errores.empty()) {
-            resumen << "=== ERRORES ENCONTRADOS ===\n" << errores;
+        // Los errores pueden ser muchos: van como filas de la vista virtual
+        if (!res.errores.empty()) {
+            resumen << "=== ERRORES ENCONTRADOS (" << res.errores.size() << ") ===";
         }
         
-        resumen << "\n=== ESTADISTICAS DEL CATALOGO ===\n";
-        resumen << generarEstadisticas();
+        std::ostringstream pie;
+        pie << "\n=== ESTADISTICAS DEL CATALOGO ===\n";
+        pie << generarEstadisticas();
         
-        textBuffer->text(resumen.str().c_str());
+        size_t n = res.errores.size();
+        mostrarListado(resumen.str(), n, [errores = std::move(res.errores)](size_t i, std::string& linea) {
+            linea = errores[i];
+        }, pie.str());
     }
     
-    std::vector<std::string> dividirCadena(const std::string& cadena, char separador) {
-        std::vector<std::string> resultado;
-        std::stringstream ss(cadena);
-        std::string item;
-        
-        while (std::getline(ss, item, separador)) {
-            item.erase(0, item.find_first_not_of(" \t"));
-            item.erase(item.find_last_not_of(" \t") + 1);
-            resultado.push_back(item);
+    // Busca un video por título usando el índice (nullptr si no existe)
+    std::shared_ptr<Video> buscarVideo(const std::string& titulo) const {
+        auto it = indiceTitulos.find(titulo);
+        return it != indiceTitulos.end() ? it->second : nullptr;
+    }
+    
+    // Variante para campos del lector: reutiliza una clave sin reservar por línea
+    std::shared_ptr<Video> buscarVideo(std::string_view titulo) const {
+        claveBusqueda.assign(titulo.data(), titulo.size());
+        return buscarVideo(claveBusqueda);
+    }
+    
+    // Agrega un video al catálogo manteniendo el índice sincronizado
+    bool agregarAlCatalogo(std::shared_ptr<Video> video) {
+        if (!video || !indiceTitulos.emplace(video->getTitulo(), video).second) {
+            return false;
         }
-        
-        return resultado;
+        idsCatalogo.push_back(video->getId());
+        catalogo.push_back(std::move(video));
+        return true;
     }
     
-    bool actualizarCalificacionExistente(const std::string& titulo, double nuevaCalificacion) {
-        for (auto& video : catalogo) {
-            if (video->getTitulo() == titulo) {
-                video->setCalificacion(nuevaCalificacion);
-                return true;
+    // Título de una línea importada: exacto o, si falla, sin distinguir
+    // mayúsculas, acentos ni signos. Con erratas no se aplica nada: la línea
+    // se salta y el error sugiere el título más parecido.
+    std::shared_ptr<Video> resolverTitulo(const OperacionDatos& op, std::string_view titulo,
+                                          ResumenImportacion& res) {
+        if (auto video = buscarVideo(titulo)) return video;
+        uint32_t fila = 0;
+        if (indiceBusqueda.resolverPlegado(titulo, fila)) {
+            res.titulosPlegados++;
+            return buscarVideo(AlmacenCatalogo::global().titulo(fila));
+        }
+        
+        // buscarAproximado recorre todo el índice de trigramas: en un archivo con
+        // miles de títulos desconocidos solo los primeros errores llevan sugerencia
+        std::string motivo = "título no encontrado: " + std::string(titulo);
+        if (res.sugerenciasCalculadas < MAX_SUGERENCIAS_IMPORTACION) {
+            res.sugerenciasCalculadas++;
+            auto sugerencias = indiceBusqueda.buscarAproximado(titulo, 1);
+            if (!sugerencias.empty()) {
+                motivo += "; ¿quiso decir \"" + std::string(AlmacenCatalogo::global().titulo(sugerencias[0].second)) + "\"?";
             }
         }
-        return false;
+        registrarError(op, motivo, res);
+        return nullptr;
+    }
+    
+    bool actualizarCalificacionExistente(const OperacionDatos& op, std::string_view titulo,
+                                         ResumenImportacion& res) {
+        auto video = resolverTitulo(op, titulo, res);
+        if (!video) return false;
+        video->setCalificacion(op.calificacion);
+        return true;
     }
     
-    void agregarNuevaPelicula(const std::vector<std::string>& partes) {
-        std::string titulo = partes[1];
-        double calificacion = std::stod(partes[2]);
-        int duracion = std::stoi(partes[3]);
-        std::string genero = partes[4];
-        std::string director = partes[5];                
-        int anio = std::stoi(partes[6]);
+    void agregarNuevaPelicula(const OperacionDatos& op, const RegistroDatos& registro) {
+        const auto& partes = registro.campos;
+        std::string_view titulo = partes[1];
         
-        for (auto& video : catalogo) {
-            if (video->getTitulo() == titulo) return;
-        }
+        if (buscarVideo(titulo)) return;
         
-        catalogo.push_back(std::make_shared<Pelicula>(
-            titulo, calificacion, duracion, genero, director, anio));
+        agregarAlCatalogo(std::make_shared<Pelicula>(
+            std::string(titulo), op.calificacion, op.duracion, std::string(partes[4]),
+            std::string(partes[5]), op.anio));
     }
     
-    void agregarNuevaSerie(const std::vector<std::string>& partes) {
-        std::string titulo = partes[1];
-        double calificacion = std::stod(partes[2]);
-        int episodiosPorTemp = std::stoi(partes[3]);
-        std::string genero = partes[4];
-        int numTemporadas = std::stoi(partes[5]);
-        int totalEpisodios = std::stoi(partes[6]);
-        std::string director = partes[7];
+    void agregarNuevaSerie(const OperacionDatos& op, const RegistroDatos& registro) {
+        const auto& partes = registro.campos;
+        std::string_view titulo = partes[1];
         
-        for (auto& video : catalogo) {
-            if (video->getTitulo() == titulo) return;
-        }
+        if (buscarVideo(titulo)) return;
         
-        catalogo.push_back(std::make_shared<Serie>(
-            titulo, calificacion, episodiosPorTemp, genero,
-            numTemporadas, totalEpisodios, director));
+        agregarAlCatalogo(std::make_shared<Serie>(
+            std::string(titulo), op.calificacion, op.episodiosPorTemporada, std::string(partes[4]),
+            op.numTemporadas, op.totalEpisodios, std::string(partes[7])));
     }
     
-    void procesarCalificacionUsuario(const std::string& usuario, 
-                                    const std::string& titulo, 
-                                    int calificacion) {
-        for (auto& video : catalogo) {
-            if (video->getTitulo() == titulo) {
-                video->actualizarCalificacion(calificacion);
-                break;
-            }
+    bool agregarEpisodio(const OperacionDatos& op, const RegistroDatos& registro, ResumenImportacion& res) {
+        const auto& partes = registro.campos;
+        auto video = resolverTitulo(op, partes[1], res);
+        if (!video) return false;
+        auto serie = std::dynamic_pointer_cast<Serie>(video);
+        try {
+            if (!serie) throw std::invalid_argument("el título no es una serie");
+            std::string_view ruta = registro.numCampos >= 6 ? partes[5] : std::string_view();
+            serie->agregarEpisodio(op.temporada, op.episodio, op.duracion, ruta, op.visto);
+        } catch (const std::exception& e) {
+            registrarError(op, e.what(), res);
+            return false;
         }
+        return true;
     }
     
-    void actualizarGeneroVideo(const std::string& titulo, const std::string& nuevoGenero) {
-        for (auto& video : catalogo) {
-            if (video->getTitulo() == titulo) {
-                video->setGenero(nuevoGenero);
-            }
+    void procesarCalificacionUsuario(const OperacionDatos& op, std::string_view usuario,
+                                     std::string_view titulo, ResumenImportacion& res) {
+        if (auto video = resolverTitulo(op, titulo, res)) {
+            video->actualizarCalificacion(op.calificacionUsuario);
         }
     }
     
-    std::string generarEstadisticas() {
-        int totalPeliculas = 0;
-        int totalSeries = 0;
-        double sumaCalificaciones = 0;
-        std::map<std::string, int> generos;
-        std::map<std::string, int> directores;
-        
-        for (auto& video : catalogo) {
-            if (video->getTipo() == "Pelicula") totalPeliculas++;
-            else totalSeries++;
-            
-            sumaCalificaciones += video->getCalificacion();
-            generos[video->getGenero()]++;
-            directores[video->getDirector()]++;
+    void actualizarGeneroVideo(const OperacionDatos& op, std::string_view titulo,
+                               std::string_view nuevoGenero, ResumenImportacion& res) {
+        if (auto video = resolverTitulo(op, titulo, res)) {
+            video->setGenero(std::string(nuevoGenero));
         }
+    }
+    
+    std::string generarEstadisticas() {
+        const EstadisticasCatalogo& est = AlmacenCatalogo::global().getEstadisticas();
         
-        double promedioCalificacion = catalogo.empty() ? 0 : sumaCalificaciones / catalogo.size();
-        
-        std::string generoMasPopular = "N/A";
-        int maxGenero = 0;
-        for (const auto& par : generos) {
-            if (par.second > maxGenero) {
-                maxGenero = par.second;
-                generoMasPopular = par.first;
-            }
-        }
+        size_t totalPeliculas = est.getTotal(AlmacenCatalogo::PELICULA);
+        size_t totalSeries = est.getTotal(AlmacenCatalogo::SERIE);
+        double promedioCalificacion = est.getPromedio();
         
-        std::string directorMasRepresentado = "N/A";
-        int maxDirector = 0;
-        for (const auto& par : directores) {
-            if (par.second > maxDirector) {
-                maxDirector = par.second;
-                directorMasRepresentado = par.first;
-            }
-        }
+        auto nombre = [](uint32_t id) {
+            return id == TablaCadenas::NINGUNO ? std::string("N/A") : textoInternado(id);
+        };
+        std::string generoMasPopular = nombre(est.getGeneros().masFrecuente());
+        int maxGenero = est.getGeneros().getMaximo();
+        std::string directorMasRepresentado = nombre(est.getDirectores().masFrecuente());
+        int maxDirector = est.getDirectores().getMaximo();
         
         std::ostringstream stats;
         stats << "Películas: " << totalPeliculas << "\n";
@@ -687,7 +4474,7 @@ private:
             rangoWin.show();
             while (rangoWin.shown()) Fl::wait();
             if (rangoWin.fueCancelado()) {
-                textBuffer->text("Operación cancelada.");
+                mostrarMensaje("Operación cancelada.");
                 return;
             }
             std::string rangoSeleccionado = rangoWin.getSeleccion();
@@ -699,45 +4486,47 @@ private:
             else if (rangoSeleccionado == "7-8") { rangoMin = 7; rangoMax = 8; }
             else if (rangoSeleccionado == "9-10") { rangoMin = 9; rangoMax = 10; }
 
+            // Parte entera en [rangoMin, rangoMax] equivale a [rangoMin, rangoMax + 1).
+            // El índice ya da el tramo ordenado de mayor a menor.
+            const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+            const IndiceCalificaciones& indice = almacen.getIndiceCalificaciones();
+            float minimo = static_cast<float>(rangoMin);
+            float maximo = static_cast<float>(rangoMax + 1);
+            
             std::vector<std::shared_ptr<Video>> videosFiltrados;
+            videosFiltrados.reserve(indice.contarRango(minimo, maximo));
+            indice.recorrerRango(minimo, maximo, [&](uint32_t fila) {
+                auto video = buscarVideo(almacen.titulo(fila));
+                if (video && video->getId() == fila) videosFiltrados.push_back(std::move(video));
+            });
+            
             std::ostringstream oss;
-            oss << "Películas y Series en el rango de calificación " << rangoSeleccionado << ":\n\n";
-
-            for (const auto& video : catalogo) {
-                if (video) {
-                    int primeraCifraCalificacion = static_cast<int>(video->getCalificacion());
-                    if (primeraCifraCalificacion >= rangoMin && primeraCifraCalificacion <= rangoMax) {
-                        videosFiltrados.push_back(video);
-                        oss << video->getInfo() << "\n\n";
-                    }
-                }
-            }
-
+            oss << "Películas y Series en el rango de calificación " << rangoSeleccionado
+                << " (" << videosFiltrados.size() << ", de mayor a menor):\n\n";
+            
+            actualizarPortadas(videosFiltrados);
             if (videosFiltrados.empty()) {
                 oss << "No se encontraron videos en el rango " << rangoSeleccionado << ".";
+                mostrarMensaje(oss.str().c_str());
+            } else {
+                mostrarListado(oss.str(), std::move(videosFiltrados));
             }
-
-            actualizarPortadas(videosFiltrados);
-            textBuffer->text(oss.str().c_str());
         } catch (const std::exception& e) {
             fl_alert("Error al mostrar películas: %s", e.what());
-            textBuffer->text("Error al mostrar películas.");
+            mostrarMensaje("Error al mostrar películas.");
         }
     }
 
 public:
     CatalogoApp() {
         setupUI();
-        cargarDatosPorDefecto();
-        historial.cargarHistorial(catalogo);
+        cargarCatalogoInicial();
         actualizarPortadas();
+        motorSimilitud.preparar();
     }
     
     ~CatalogoApp() {
         delete textBuffer;
-        for (auto* portada : portadas) {
-            delete portada;
-        }
     }
 
     void run() {
@@ -749,9 +4538,40 @@ public:
         mostrarEpisodiosSerie();
     }   
 
+    // Posiciones de catalogo ordenadas de mayor a menor calificación; a
+    // igualdad se conserva el orden actual
+    std::vector<uint32_t> ordenarPosiciones(const std::vector<uint32_t>& posiciones) const {
+        const auto& calificaciones = AlmacenCatalogo::global().getCalificaciones();
+        PoolHilos& pool = PoolHilos::compartido();
+        std::vector<uint64_t> claves(posiciones.size());
+        pool.paraRangos(claves.size(), [&](size_t, size_t desde, size_t hasta) {
+            for (size_t i = desde; i < hasta; i++) {
+                claves[i] = IndiceCalificaciones::claveOrden(calificaciones[idsCatalogo[posiciones[i]]],
+                                                             posiciones[i]);
+            }
+        });
+        ordenarEnParalelo(claves, std::less<uint64_t>());
+        
+        std::vector<uint32_t> ordenadas(claves.size());
+        for (size_t i = 0; i < claves.size(); i++) ordenadas[i] = static_cast<uint32_t>(claves[i]);
+        return ordenadas;
+    }
+    
     void ordenarPorCalificacion() {
-        std::sort(catalogo.begin(), catalogo.end(), 
-            [](const auto& a, const auto& b) { return *a > *b; });
+        std::vector<uint32_t> todas(catalogo.size());
+        std::iota(todas.begin(), todas.end(), 0u);
+        std::vector<uint32_t> orden = ordenarPosiciones(todas);
+        
+        std::vector<std::shared_ptr<Video>> ordenado(orden.size());
+        std::vector<uint32_t> idsOrdenados(orden.size());
+        PoolHilos::compartido().paraRangos(orden.size(), [&](size_t, size_t desde, size_t hasta) {
+            for (size_t i = desde; i < hasta; i++) {
+                ordenado[i] = std::move(catalogo[orden[i]]);
+                idsOrdenados[i] = idsCatalogo[orden[i]];
+            }
+        });
+        catalogo.swap(ordenado);
+        idsCatalogo.swap(idsOrdenados);
     }
 
     void ajustarCalificaciones() {
@@ -776,30 +4596,30 @@ public:
         
             std::string operacion = opWin.getSeleccion();
         
-            for (auto& video : catalogo) {
-                if (video->getTitulo() == tituloSeleccionado) {
-                    double calAnterior = video->getCalificacion();
-                
-                    if (operacion == "Aumentar +0.5") {
-                        *video += 0.5;
-                    } else if (operacion == "Disminuir -0.5") {
-                        *video -= 0.5;
-                    } else if (operacion == "Aumentar +1.0") {
-                        *video += 1.0;
-                    } else if (operacion == "Disminuir -1.0") {
-                        *video -= 1.0;
-                    }
-                
-                    std::ostringstream oss;
-                    oss << "Calificación ajustada:\n";
-                    oss << "Video: " << video->getTitulo() << "\n";
-                    oss << "Calificación anterior: " << std::fixed << std::setprecision(1) << calAnterior << "\n";
-                    oss << "Nueva calificación: " << std::fixed << std::setprecision(1) << video->getCalificacion() << "\n";
-                
-                    textBuffer->text(oss.str().c_str());
-                    actualizarPortadas();
-                    break;
+            if (auto video = buscarVideo(tituloSeleccionado)) {
+                double calAnterior = video->getCalificacion();
+            
+                if (operacion == "Aumentar +0.5") {
+                    *video += 0.5;
+                } else if (operacion == "Disminuir -0.5") {
+                    *video -= 0.5;
+                } else if (operacion == "Aumentar +1.0") {
+                    *video += 1.0;
+                } else if (operacion == "Disminuir -1.0") {
+                    *video -= 1.0;
                 }
+                registrarCalificacion(*video);
+            
+                std::ostringstream oss;
+                oss << "Calificación ajustada:\n";
+                oss << "Video: " << video->getTitulo() << "\n";
+                oss << "Calificación anterior: " << std::fixed << std::setprecision(1) << calAnterior << "\n";
+                oss << "Nueva calificación: " << std::fixed << std::setprecision(1) << video->getCalificacion() << "\n";
+                oss << "Puesto en el catálogo: " << AlmacenCatalogo::global().puestoPorCalificacion(video->getId())
+                    << " de " << AlmacenCatalogo::global().getIndiceCalificaciones().size() << "\n";
+            
+                mostrarMensaje(oss.str().c_str());
+                scrollPortadas->refrescarVideo(video);
             }
         
         } catch (const std::exception& e) {
@@ -809,17 +4629,104 @@ public:
 
     void mostrarMejorCalificado() {
         if (catalogo.empty()) {
-            textBuffer->text("No hay videos en el catálogo.");
+            mostrarMensaje("No hay videos en el catálogo.");
             return;
         }
     
-        auto mejor = *std::max_element(catalogo.begin(), catalogo.end(),
-            [](const auto& a, const auto& b) { return *a < *b; });
+        const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+        const IndiceCalificaciones& indice = almacen.getIndiceCalificaciones();
+        auto mejor = indice.empty() ? nullptr : buscarVideo(almacen.titulo(indice.filaEn(0)));
+        if (!mejor) {
+            mostrarMensaje("No hay videos en el catálogo.");
+            return;
+        }
     
         std::ostringstream oss;
         oss << "Video con mejor calificación:\n\n";
         oss << *mejor;
-        textBuffer->text(oss.str().c_str());
+        mostrarMensaje(oss.str().c_str());
+    }
+
+    void mostrarMejoresK() {
+        try {
+            const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+            const ContadorFrecuencias& conteoGeneros = almacen.getEstadisticas().getGeneros();
+            
+            std::set<std::string> generos;
+            for (uint32_t g = 0; g < TablaCadenas::global().size(); g++) {
+                if (conteoGeneros.getCuenta(g) > 0) generos.insert(textoInternado(g));
+            }
+            std::vector<std::string> opcionesGenero = {"Todos los géneros"};
+            opcionesGenero.insert(opcionesGenero.end(), generos.begin(), generos.end());
+            
+            SelectorWindow genWin("Seleccionar Genero", opcionesGenero);
+            genWin.show();
+            while (genWin.shown()) Fl::wait();
+            if (genWin.fueCancelado()) {
+                mostrarMensaje("Operación cancelada.");
+                return;
+            }
+            std::string generoSeleccionado = genWin.getSeleccion();
+            
+            std::vector<std::string> opcionesTipo = {"Películas y series", "Solo películas", "Solo series"};
+            SelectorWindow tipoWin("Seleccionar Tipo", opcionesTipo);
+            tipoWin.show();
+            while (tipoWin.shown()) Fl::wait();
+            if (tipoWin.fueCancelado()) {
+                mostrarMensaje("Operación cancelada.");
+                return;
+            }
+            std::string tipoSeleccionado = tipoWin.getSeleccion();
+            
+            const char* input = fl_input("¿Cuántos títulos mostrar?", "50");
+            if (!input) {
+                mostrarMensaje("Operación cancelada.");
+                return;
+            }
+            int k = std::stoi(input);
+            if (k < 1) {
+                fl_alert("La cantidad debe ser al menos 1.");
+                return;
+            }
+            
+            AlmacenCatalogo::FiltroMejores filtro;
+            if (generoSeleccionado != opcionesGenero[0]) {
+                filtro.genero = TablaCadenas::global().buscar(generoSeleccionado);
+            }
+            if (tipoSeleccionado == opcionesTipo[1]) filtro.tipo = AlmacenCatalogo::PELICULA;
+            else if (tipoSeleccionado == opcionesTipo[2]) filtro.tipo = AlmacenCatalogo::SERIE;
+            
+            auto inicio = std::chrono::steady_clock::now();
+            std::vector<uint32_t> filas = almacen.mejores(static_cast<size_t>(k), filtro);
+            std::chrono::duration<double, std::milli> duracion = std::chrono::steady_clock::now() - inicio;
+            
+            std::vector<std::shared_ptr<Video>> videosFiltrados;
+            videosFiltrados.reserve(filas.size());
+            for (uint32_t fila : filas) {
+                if (auto video = buscarVideo(almacen.titulo(fila))) videosFiltrados.push_back(video);
+            }
+            
+            std::ostringstream oss;
+            oss << "Top " << k << " - " << generoSeleccionado << " - " << tipoSeleccionado
+                << " (" << std::fixed << std::setprecision(3) << duracion.count() << " ms)\n\n";
+            
+            actualizarPortadas(videosFiltrados);
+            if (videosFiltrados.empty()) {
+                oss << "No hay títulos que cumplan el filtro.";
+                mostrarMensaje(oss.str().c_str());
+                return;
+            }
+            size_t n = videosFiltrados.size();
+            mostrarListado(oss.str(), n, [videos = std::move(videosFiltrados)](size_t i, std::string& linea) {
+                agregarEntero(linea, static_cast<long long>(i + 1));
+                linea += ". ";
+                linea += videos[i]->getTitulo();
+                linea += " - ";
+                agregarDecimal(linea, videos[i]->getCalificacion(), 1);
+            });
+        } catch (const std::exception& e) {
+            fl_alert("Error: %s", e.what());
+        }
     }
 
     void mostrarVideosSimilares() {
@@ -835,34 +4742,52 @@ public:
             if (tituloWin.fueCancelado()) return;
         
             std::string tituloSeleccionado = tituloWin.getSeleccion();
-            std::shared_ptr<Video> videoBase = nullptr;
+            std::shared_ptr<Video> videoBase = buscarVideo(tituloSeleccionado);
         
-            for (const auto& video : catalogo) {
-                if (video->getTitulo() == tituloSeleccionado) {
-                    videoBase = video;
-                    break;
+            if (!videoBase) return;
+            
+            const char* input = fl_input("¿Cuántos títulos parecidos mostrar?", "20");
+            if (!input) return;
+            int k = std::stoi(input);
+            if (k < 1) {
+                fl_alert("La cantidad debe ser al menos 1.");
+                return;
+            }
+            
+            auto inicio = std::chrono::steady_clock::now();
+            bool usoArbol = false;
+            auto parecidos = motorSimilitud.buscar(videoBase->getId(), static_cast<size_t>(k), usoArbol);
+            std::chrono::duration<double, std::milli> duracion = std::chrono::steady_clock::now() - inicio;
+            
+            const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+            std::vector<std::shared_ptr<Video>> similares;
+            std::vector<float> distancias;
+            similares.reserve(parecidos.size());
+            distancias.reserve(parecidos.size());
+            for (const auto& par : parecidos) {
+                if (auto video = buscarVideo(almacen.titulo(par.second))) {
+                    similares.push_back(video);
+                    distancias.push_back(par.first);
                 }
             }
         
-            if (!videoBase) return;
-        
             std::ostringstream oss;
             oss << "Videos similares a: " << videoBase->getTitulo() << "\n";
-            oss << "Calificación base: " << videoBase->getCalificacion() << "\n\n";
-        
-            for (const auto& video : catalogo) {
-                if (video != videoBase) {
-                    if (*video > *videoBase) {
-                        oss << "MEJOR: " << *video << "\n\n";
-                    } else if (*video < *videoBase) {
-                        oss << "MENOR: " << *video << "\n\n";
-                    } else {
-                        oss << "IGUAL: " << *video << "\n\n";
-                    }
-                }
-            }
-        
-            textBuffer->text(oss.str().c_str());
+            oss << "Calificación base: " << videoBase->getCalificacion() << "\n";
+            oss << similares.size() << " más parecidos por género, director, tipo, año, calificación y duración ("
+                << (usoArbol ? "árbol de similitud" : "recorrido completo") << ", "
+                << std::fixed << std::setprecision(3) << duracion.count() << " ms)\n";
+            
+            actualizarPortadas(similares);
+            size_t n = similares.size();
+            mostrarListado(oss.str(), n, [similares = std::move(similares), distancias = std::move(distancias)]
+                                         (size_t i, std::string& linea) {
+                agregarEntero(linea, static_cast<long long>(i + 1));
+                linea += ". [";
+                agregarDecimal(linea, distancias[i], 2);
+                linea += "] ";
+                similares[i]->escribirInfo(linea);
+            });
         
         } catch (const std::exception& e) {
             fl_alert("Error: %s", e.what());
@@ -883,6 +4808,7 @@ private:
         menuChoice->add("6. Ordenar por calificación");
         menuChoice->add("7. Mostrar mejor calificado");
         menuChoice->add("8. Comparar videos");
+        menuChoice->add("9. Mejores K por género o tipo");
         menuChoice->add("0. Salir");
         menuChoice->value(0);
         menuChoice->color(FL_DARK3);
@@ -896,6 +4822,8 @@ private:
         filtroInput = new Fl_Input(480, 20, 150, 30, "Filtro:");
         filtroInput->color(FL_DARK3);
         filtroInput->textcolor(FL_WHITE);
+        filtroInput->when(FL_WHEN_CHANGED);
+        filtroInput->callback(filtroCallback, this);
         
         calificacionSpinner = new Fl_Spinner(700, 20, 80, 30, "Cal. mín:");
         calificacionSpinner->minimum(0);
@@ -903,16 +4831,11 @@ private:
         calificacionSpinner->value(0);
         calificacionSpinner->color(FL_DARK3);
         calificacionSpinner->textcolor(FL_WHITE);
+        calificacionSpinner->callback(filtroCallback, this);
         
-        scrollPortadas = new Fl_Scroll(20, 70, 960, 300);
+        scrollPortadas = new CarruselPortadas(20, 70, 960, 300, this);
         scrollPortadas->color(FL_BLACK);
         
-        packPortadas = new Fl_Pack(25, 75, 950, 290);
-        packPortadas->type(Fl_Pack::HORIZONTAL);
-        packPortadas->spacing(10);
-        
-        scrollPortadas->end();
-        
         Fl_Box* labelResultados = new Fl_Box(20, 380, 100, 20, "Resultados:");
         labelResultados->align(FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
         labelResultados->labelcolor(FL_WHITE);
@@ -924,6 +4847,9 @@ private:
         resultadosDisplay->color(FL_DARK3);
         resultadosDisplay->textcolor(FL_WHITE);
         
+        listaResultados = new ListaResultados(20, 400, 960, 280);
+        listaResultados->hide();
+        
         window->end();
     }
     
@@ -932,6 +4858,77 @@ private:
         app->ejecutarOpcion();
     }
     
+    // Cada tecla reinicia la espera; la búsqueda corre al dejar de escribir
+    static void filtroCallback(Fl_Widget*, void* data) {
+        Fl::remove_timeout(busquedaCallback, data);
+        Fl::add_timeout(0.15, busquedaCallback, data);
+    }
+    
+    static void busquedaCallback(void* data) {
+        static_cast<CatalogoApp*>(data)->buscarEnVivo();
+    }
+    
+    void buscarEnVivo() {
+        try {
+            std::string consulta = filtroInput->value() ? filtroInput->value() : "";
+            double minima = calificacionSpinner->value();
+            if (consulta.empty() && minima <= 0) {
+                actualizarPortadas();
+                mostrarMensaje("");
+                return;
+            }
+            
+            auto inicio = std::chrono::steady_clock::now();
+            std::vector<uint64_t> bitmap;
+            size_t total = indiceBusqueda.buscar(consulta, minima, bitmap);
+            std::chrono::duration<double, std::milli> duracion = std::chrono::steady_clock::now() - inicio;
+            
+            std::vector<std::shared_ptr<Video>> resultados;
+            resultados.reserve(total);
+            for (uint32_t pos : filtrarEnParalelo(idsCatalogo.size(), [&](size_t i) {
+                     return bitActivo(bitmap, idsCatalogo[i]);
+                 })) {
+                resultados.push_back(catalogo[pos]);
+            }
+            
+            // Sin coincidencias: títulos parecidos, por si hay una errata
+            bool aproximados = false;
+            if (resultados.empty() && !consulta.empty()) {
+                const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+                for (const auto& par : indiceBusqueda.buscarAproximado(consulta, 50)) {
+                    auto video = buscarVideo(almacen.titulo(par.second));
+                    if (video && video->getCalificacion() >= minima) resultados.push_back(video);
+                }
+                aproximados = !resultados.empty();
+            }
+            
+            // Tanto la tira de portadas como la lista están virtualizadas
+            std::ostringstream oss;
+            if (aproximados) {
+                oss << "Sin coincidencias; títulos parecidos a \"" << consulta << "\"";
+            } else {
+                oss << resultados.size() << " resultado(s) para \"" << consulta << "\"";
+            }
+            oss << " con calificación >= " << std::fixed << std::setprecision(1) << minima
+                << " (" << std::setprecision(3) << duracion.count() << " ms)\n";
+            
+            scrollPortadas->establecerVideos(resultados);
+            size_t n = resultados.size();
+            mostrarListado(oss.str(), n, [resultados = std::move(resultados)](size_t i, std::string& linea) {
+                const Video& video = *resultados[i];
+                linea += video.getTitulo();
+                linea += " - ";
+                linea += video.getGenero();
+                linea += " - ";
+                linea += video.getDirector();
+                linea += " - ";
+                agregarDecimal(linea, video.getCalificacion(), 1);
+            });
+        } catch (const std::exception& e) {
+            fl_alert("Error en la búsqueda: %s", e.what());
+        }
+    }
+    
     void ejecutarOpcion() {
         int opcion = menuChoice->value();
     
@@ -945,7 +4942,7 @@ private:
                 case 5:
                     ordenarPorCalificacion();
                     actualizarPortadas();
-                    textBuffer->text("Catálogo ordenado por calificación (mayor a menor)");
+                    mostrarMensaje("Catálogo ordenado por calificación (mayor a menor)");
                     break;
                 case 6:
                     mostrarMejorCalificado();
@@ -954,6 +4951,9 @@ private:
                     mostrarVideosSimilares();
                     break;
                 case 8:
+                    mostrarMejoresK();
+                    break;
+                case 9:
                     guardarHistorialAlCerrar();
                     window->hide();
                     Fl::delete_widget(window);
@@ -970,93 +4970,99 @@ private:
     }
     
     void cargarDatosPorDefecto() {
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "La princesa Mononoke", 8.4, 134, "Fantasia",
             "Hayao Miyazaki", 1997));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "El viaje de Chihiro", 8.6, 125, "Fantasia",
             "Hayao Miyazaki", 2001));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "Look Back", 8.1, 90, "Drama",
             "Kiyotaka Oshiyama", 2021));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "Star Wars Episodio I La amenaza fantasma", 6.5, 136, "Ciencia Ficcion",
             "George Lucas", 1999));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "Star Wars Episodio II El ataque de los clones", 6.5, 142, "Ciencia Ficcion",
             "George Lucas", 2002));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "Star Wars Episodio III La venganza de los Sith", 7.5, 140, "Ciencia Ficcion",
             "George Lucas", 2005));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "Star Wars Episodio IV Una nueva esperanza", 8.6, 121, "Ciencia Ficcion",
             "George Lucas", 1977));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "Star Wars Episodio V El imperio contraataca", 8.7, 124, "Ciencia Ficcion",
             "Irvin Kershner", 1980));
-        catalogo.push_back(std::make_shared<Pelicula>(
+        agregarAlCatalogo(std::make_shared<Pelicula>(
             "Star Wars Episodio VI El retorno del Jedi", 8.3, 131, "Ciencia Ficcion",
             "Richard Marquand", 1983));
         
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Jujutsu Kaisen", 8.7, 24, "Accion",
             2, 47, "Sunghoo Park"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Pokemon", 7.5, 22, "Aventura",
             25, 1200, "Kunihiko Yuyama"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Violet Evergarden", 8.8, 24, "Drama",
             1, 13, "Taichi Ishidate"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Kimetsu no Yaiba", 8.7, 24, "Accion",
             3, 55, "Haruo Sotozaki"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Attack on Titan", 9.0, 24, "Accion",
             4, 87, "Tetsuro Araki"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Blue Lock", 8.3, 24, "Deporte",
             1, 24, "Tetsuaki Watanabe"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Star Wars The Clone Wars", 8.4, 22, "Ciencia Ficcion",
             7, 133, "Dave Filoni"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Ann", 7.9, 45, "Drama",
             1, 10, "Unknown"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Nadie nos va a extrañar", 8.1, 45, "Crimen",
             1, 10, "Unknown"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Si la vida te da mandarinas", 7.8, 45, "Comedia",
             1, 10, "Unknown"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Goblin", 8.9, 70, "Romance",
             1, 16, "Lee Eung-bok"));
-        catalogo.push_back(std::make_shared<Serie>(
+        agregarAlCatalogo(std::make_shared<Serie>(
             "Alien Stage", 8.5, 15, "Musical",
             1, 6, "Unknown"));
     }
     
+    // Los mensajes van al área de texto; los listados, a la vista virtual
+    void mostrarMensaje(const char* texto) {
+        listaResultados->hide();
+        resultadosDisplay->show();
+        textBuffer->text(texto);
+    }
+    
+    void mostrarListado(const std::string& encabezado, size_t n, ListaResultados::Formateador formatear,
+                        const std::string& pie = "") {
+        textBuffer->text("");
+        resultadosDisplay->hide();
+        listaResultados->establecer(encabezado, n, std::move(formatear), pie);
+        listaResultados->show();
+    }
+    
+    // Una fila por video con su getInfo
+    void mostrarListado(const std::string& encabezado, std::vector<std::shared_ptr<Video>> videos,
+                        const std::string& pie = "") {
+        size_t n = videos.size();
+        mostrarListado(encabezado, n, [videos = std::move(videos)](size_t i, std::string& linea) {
+            videos[i]->escribirInfo(linea);
+        }, pie);
+    }
+    
     void actualizarPortadas(const std::vector<std::shared_ptr<Video>>& videosFiltrados = {}) {
         try {
-            for (auto* portada : portadas) {
-                packPortadas->remove(portada);
-                delete portada;
-            }
-            portadas.clear();
-            
-            const auto& videos = videosFiltrados.empty() ? catalogo : videosFiltrados;
-            int x = 25;
-            for (const auto& video : videos) {
-                if (video) {
-                    PortadaBox* portada = new PortadaBox(x, 75, video, this);
-                    portadas.push_back(portada);
-                    packPortadas->add(portada);
-                    x += 130;
-                }
-            }
-            
-            packPortadas->redraw();
-            scrollPortadas->redraw();
+            scrollPortadas->establecerVideos(videosFiltrados.empty() ? catalogo : videosFiltrados);
         } catch (const std::exception& e) {
             fl_alert("Error al actualizar portadas: %s", e.what());
         }
@@ -1076,7 +5082,7 @@ private:
             tipoWin.show();
             while (tipoWin.shown()) Fl::wait();
             if (tipoWin.fueCancelado()) {
-                textBuffer->text("Operación cancelada.");
+                mostrarMensaje("Operación cancelada.");
                 return;
             }
             std::string tipoSeleccionado = tipoWin.getSeleccion();
@@ -1084,10 +5090,15 @@ private:
             std::vector<std::shared_ptr<Video>> videosFiltrados;
             std::ostringstream resultado;
             
+            const AlmacenCatalogo& almacen = AlmacenCatalogo::global();
+            
             if (tipoSeleccionado == "Por Genero") {
+                const auto& columnaGeneros = almacen.getGeneros();
+                std::vector<bool> presente(TablaCadenas::global().size(), false);
+                for (uint32_t id : idsCatalogo) presente[columnaGeneros[id]] = true;
                 std::set<std::string> generos;
-                for (const auto& video : catalogo) {
-                    if (video) generos.insert(video->getGenero());
+                for (uint32_t g = 0; g < presente.size(); g++) {
+                    if (presente[g]) generos.insert(textoInternado(g));
                 }
                 std::vector<std::string> listaGeneros(generos.begin(), generos.end());
                 
@@ -1095,19 +5106,19 @@ private:
                 genWin.show();
                 while (genWin.shown()) Fl::wait();
                 if (genWin.fueCancelado()) {
-                    textBuffer->text("Operación cancelada.");
+                    mostrarMensaje("Operación cancelada.");
                     return;
                 }
                 std::string generoSeleccionado = genWin.getSeleccion();
                 
                 resultado << "Videos del género \"" << generoSeleccionado << "\":\n\n";
                 
-                for (const auto& video : catalogo) {
-                    if (video && video->getGenero() == generoSeleccionado) {
-                        videosFiltrados.push_back(video);
-                        resultado << video->getInfo() << "\n\n";
-                    }
-                }
+                uint32_t generoId = TablaCadenas::global().buscar(generoSeleccionado);
+                auto posiciones = filtrarEnParalelo(idsCatalogo.size(), [&](size_t i) {
+                    return columnaGeneros[idsCatalogo[i]] == generoId;
+                });
+                videosFiltrados.reserve(posiciones.size());
+                for (uint32_t pos : posiciones) videosFiltrados.push_back(catalogo[pos]);
                 
             } else if (tipoSeleccionado == "Por Calificacion") {
                 std::vector<std::string> rangos = {"1-2", "3-4", "5-6", "7-8", "9-10"};
@@ -1115,7 +5126,7 @@ private:
                 rangoWin.show();
                 while (rangoWin.shown()) Fl::wait();
                 if (rangoWin.fueCancelado()) {
-                    textBuffer->text("Operación cancelada.");
+                    mostrarMensaje("Operación cancelada.");
                     return;
                 }
                 std::string rangoSeleccionado = rangoWin.getSeleccion();
@@ -1129,37 +5140,44 @@ private:
                 
                 resultado << "Videos con calificación en el rango " << rangoSeleccionado << ":\n\n";
                 
-                for (const auto& video : catalogo) {
-                    if (video && video->getCalificacion() >= calMin && video->getCalificacion() <= calMax) {
-                        videosFiltrados.push_back(video);
-                        resultado << video->getInfo() << "\n\n";
-                    }
-                }
+                // Rango cerrado: el límite superior se corre al siguiente float
+                std::vector<uint64_t> seleccion;
+                filtrarCalificaciones(almacen.getCalificaciones(), static_cast<float>(calMin),
+                                      std::nextafter(static_cast<float>(calMax),
+                                                     std::numeric_limits<float>::infinity()),
+                                      seleccion);
+                auto posiciones = filtrarEnParalelo(idsCatalogo.size(), [&](size_t i) {
+                    return bitActivo(seleccion, idsCatalogo[i]);
+                });
+                videosFiltrados.reserve(posiciones.size());
+                for (uint32_t pos : posiciones) videosFiltrados.push_back(catalogo[pos]);
             }
             
             if (videosFiltrados.empty()) {
                 resultado << "No se encontraron videos que cumplan con el criterio seleccionado.";
+                mostrarMensaje(resultado.str().c_str());
+            } else {
+                mostrarListado(resultado.str(), std::move(videosFiltrados));
             }
             
-            textBuffer->text(resultado.str().c_str());
-            
         } catch (const std::exception& e) {
             fl_alert("Error al mostrar videos: %s", e.what());
-            textBuffer->text("Error al mostrar videos.");
+            mostrarMensaje("Error al mostrar videos.");
         }
     }
     
     void mostrarEpisodiosSerie() {
         try {
             std::vector<std::string> series;
-            for (const auto& video : catalogo) {
-                if (video && video->getTipo() == "Serie") {
-                    series.push_back(video->getTitulo());
+            const auto& tipos = AlmacenCatalogo::global().getTipos();
+            for (size_t i = 0; i < idsCatalogo.size(); i++) {
+                if (tipos[idsCatalogo[i]] == AlmacenCatalogo::SERIE) {
+                    series.push_back(catalogo[i]->getTitulo());
                 }
             }
             
             if (series.empty()) {
-                textBuffer->text("No hay series disponibles en el catálogo.");
+                mostrarMensaje("No hay series disponibles en el catálogo.");
                 return;
             }
             
@@ -1167,53 +5185,35 @@ private:
             serieWin.show();
             while (serieWin.shown()) Fl::wait();
             if (serieWin.fueCancelado()) {
-                textBuffer->text("Operación cancelada.");
+                mostrarMensaje("Operación cancelada.");
                 return;
             }
             std::string serieSeleccionada = serieWin.getSeleccion();
             
-            std::shared_ptr<Serie> serieEncontrada = nullptr;
-            for (const auto& video : catalogo) {
-                if (video && video->getTipo() == "Serie" && video->getTitulo() == serieSeleccionada) {
-                    serieEncontrada = std::dynamic_pointer_cast<Serie>(video);
-                    break;
-                }
-            }
+            std::shared_ptr<Serie> serieEncontrada =
+                std::dynamic_pointer_cast<Serie>(buscarVideo(serieSeleccionada));
             
             if (!serieEncontrada) {
-                textBuffer->text("Error: No se pudo encontrar la serie seleccionada.");
+                mostrarMensaje("Error: No se pudo encontrar la serie seleccionada.");
                 return;
             }
             
-            std::vector<std::string> episodios;
-            int epNum = 1;
-            for (int temp = 1; temp <= serieEncontrada->getNumTemporadas(); temp++) {
-                int epsEstaTemporada = std::min(serieEncontrada->getEpisodiosPorTemporada(), 
-                                              serieEncontrada->getTotalEpisodios() - (epNum - 1));
-                for (int ep = 1; ep <= epsEstaTemporada; ep++, epNum++) {
-                    std::ostringstream episodioStr;
-                    episodioStr << "T" << temp << "E" << ep << " - Episodio " << epNum;
-                    episodios.push_back(episodioStr.str());
-                }
+            if (serieEncontrada->getCantidadEpisodios() == 0) {
+                mostrarMensaje("La serie seleccionada no tiene episodios.");
+                return;
             }
             
-            SelectorWindow episodioWin("Seleccionar Episodio para Reproducir", episodios);
+            // Los episodios se calculan a medida que la tabla los muestra
+            SelectorEpisodiosWindow episodioWin("Seleccionar Episodio para Reproducir", *serieEncontrada);
             episodioWin.show();
             while (episodioWin.shown()) Fl::wait();
             if (episodioWin.fueCancelado()) {
-                textBuffer->text("Operación cancelada.");
+                mostrarMensaje("Operación cancelada.");
                 return;
             }
-            std::string episodioSeleccionado = episodioWin.getSeleccion();
-            
-            std::string nombreArchivo = tituloANombreArchivo(serieSeleccionada);
-            
-            std::string temp_ep = episodioSeleccionado.substr(0, episodioSeleccionado.find(" - "));
-            std::string episodio_formato = temp_ep;
-            std::transform(episodio_formato.begin(), episodio_formato.end(), episodio_formato.begin(), ::tolower);
-            episodio_formato[0] = 's';
-            
-            std::string rutaEpisodio = ".\\videos\\series\\" + nombreArchivo + "_" + episodio_formato + ".mp4";
+            int indiceEpisodio = episodioWin.getSeleccion();
+            std::string episodioSeleccionado = serieEncontrada->getEpisodio(indiceEpisodio).etiqueta();
+            std::string rutaEpisodio = serieEncontrada->getRutaEpisodio(indiceEpisodio);
             
             std::string comando = "start \"\" \"" + rutaEpisodio + "\"";
             int resultado = system(comando.c_str());
@@ -1227,6 +5227,7 @@ private:
             info << serieEncontrada->getInfo() << "\n\n";
             
             if (resultado == 0) {
+                serieEncontrada->marcarVisto(indiceEpisodio);
                 info << "Estado: Intentando reproducir episodio...\n";
                 info << "Nota: Si el archivo no se encuentra, verifica que exista en la ruta especificada.";
             } else {
@@ -1234,11 +5235,11 @@ private:
                 info << "Verifica que el archivo existe y que tienes un reproductor de video configurado.";
             }
             
-            textBuffer->text(info.str().c_str());
+            mostrarMensaje(info.str().c_str());
             
         } catch (const std::exception& e) {
             fl_alert("Error al mostrar episodios: %s", e.what());
-            textBuffer->text("Error al mostrar episodios.");
+            mostrarMensaje("Error al mostrar episodios.");
         }
     }
     
@@ -1253,7 +5254,7 @@ private:
             tituloWin.show();
             while (tituloWin.shown()) Fl::wait();
             if (tituloWin.fueCancelado()) {
-                textBuffer->text("Operación cancelada.");
+                mostrarMensaje("Operación cancelada.");
                 return;
             }
             std::string tituloSeleccionado = tituloWin.getSeleccion();
@@ -1262,25 +5263,25 @@ private:
             if (input) {
                 int calificacion = std::stoi(input);
                 if (calificacion >= 1 && calificacion <= 10) {
-                    for (auto& video : catalogo) {
-                        if (video && video->getTitulo() == tituloSeleccionado) {
-                            double calificacionAnterior = video->getCalificacion();
-                            video->actualizarCalificacion(calificacion);
-                        
-                            // Guardar el historial completo actualizado
-                            historial.actualizarHistorialCompleto(catalogo);
-                        
-                            std::ostringstream oss;
-                            oss << "Calificación actualizada para: " << video->getTitulo() 
-                                << "\nCalificación anterior: " << std::fixed << std::setprecision(1) << calificacionAnterior
-                                << "\nNueva calificación: " << std::fixed << std::setprecision(1) << video->getCalificacion()
-                                << "\n\nHistorial guardado en: historialDatos.txt";
-                        
-                            textBuffer->text(oss.str().c_str());
-                            fl_message("Calificación guardada exitosamente");
-                            actualizarPortadas();
-                            return;
-                        }
+                    if (auto video = buscarVideo(tituloSeleccionado)) {
+                        double calificacionAnterior = video->getCalificacion();
+                        video->actualizarCalificacion(calificacion);
+                    
+                        // Agregar la calificación a la bitácora del historial
+                        registrarCalificacion(*video);
+                    
+                        std::ostringstream oss;
+                        oss << "Calificación actualizada para: " << video->getTitulo() 
+                            << "\nCalificación anterior: " << std::fixed << std::setprecision(1) << calificacionAnterior
+                            << "\nNueva calificación: " << std::fixed << std::setprecision(1) << video->getCalificacion()
+                            << "\nPuesto en el catálogo: " << AlmacenCatalogo::global().puestoPorCalificacion(video->getId())
+                            << " de " << AlmacenCatalogo::global().getIndiceCalificaciones().size()
+                            << "\n\nHistorial guardado en: historialDatos.txt";
+                    
+                        mostrarMensaje(oss.str().c_str());
+                        fl_message("Calificación guardada exitosamente");
+                        scrollPortadas->refrescarVideo(video);
+                        return;
                     }
                     fl_alert("No se encontró el video");
                 } else {
@@ -1289,14 +5290,17 @@ private:
             }
         } catch (const std::exception& e) {
             fl_alert("Error al calificar video: %s", e.what());
-            textBuffer->text("Error al calificar video.");
+            mostrarMensaje("Error al calificar video.");
         }
     }
 };
 
+// bench.cpp incluye este archivo para medir sus clases sin abrir la ventana
+#ifndef CATALOGO_SIN_MAIN
 int main() {
     try {
         fl_register_images();
+        Fl::lock();     // habilita Fl::awake desde los hilos de portadas
         CatalogoApp app;
         app.run();
         return 0;
@@ -1304,4 +5308,5 @@ int main() {
         fl_alert("Error en la aplicación: %s", e.what());
         return 1;
     }
-}
\ No newline at end of file
+}
+#endif